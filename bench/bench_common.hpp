@@ -0,0 +1,56 @@
+#ifndef __BENCH_COMMON_HPP__
+#define __BENCH_COMMON_HPP__
+
+#include <chunk.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace bench {
+
+// Rolling surface with dirt/grass layers and scattered single-block pockets. +y points down.
+template <typename Layout>
+void generateTerrain(engine::BasicChunk<Layout>& chunk) {
+    const int length = static_cast<int>(engine::CHUNK_LENGTH);
+    for (int z = 0; z < length; z++) {
+        for (int x = 0; x < length; x++) {
+            const int height = 16 + ((x * 7 + z * 13) % 9) - 4;
+            for (int y = height; y < length; y++) {
+                const uint32_t hash = (static_cast<uint32_t>(x) * 73856093u)
+                    ^ (static_cast<uint32_t>(y) * 19349663u)
+                    ^ (static_cast<uint32_t>(z) * 83492791u);
+                if (hash % 11 == 0) continue;
+                chunk.setBlockUnchecked(x, y, z, y == height ? engine::GRASS : (y < height + 4 ? engine::DIRT : engine::STONE));
+            }
+        }
+    }
+}
+
+struct Timing {
+    double best = 0.0;    // microseconds
+    double average = 0.0; // microseconds
+    double p99 = 0.0;     // microseconds, the tail a frame budget has to absorb
+};
+
+template <typename Fn>
+Timing measure(int iterations, Fn&& fn) {
+    std::vector<double> samples(static_cast<size_t>(iterations));
+    Timing timing{};
+    for (double& us : samples) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        us = std::chrono::duration<double, std::micro>(end - start).count();
+        timing.average += us / iterations;
+    }
+    std::sort(samples.begin(), samples.end());
+    timing.best = samples.front();
+    timing.p99 = samples[(samples.size() - 1) * 99 / 100];
+    return timing;
+}
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,113 @@
+// Encode and decode throughput (of the 32 KiB of blocks per chunk) and compression ratio of
+// ChunkCodec on generated terrain, for each storage layout, with and without the LZ pass.
+// Every decoded chunk is checked against the original.
+
+#include "bench_common.hpp"
+
+#include <chunk_codec.hpp>
+#include <world_generator.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int ITERATIONS = 5;
+constexpr int GRID = 8;
+constexpr uint64_t SEED = 1337;
+
+// GRID x GRID columns of the two chunk layers that hold the terrain, decorations applied
+std::vector<engine::Chunk> generateChunks() {
+    const engine::WorldGenerator generator{SEED};
+    engine::WorkStealingPool pool{};
+    std::vector<glm::ivec3> coords;
+    for (int y = -1; y <= 0; y++) {
+        for (int z = 0; z < GRID; z++) {
+            for (int x = 0; x < GRID; x++) {
+                coords.push_back({x, y, z});
+            }
+        }
+    }
+    std::vector<engine::Chunk> chunks(coords.size());
+    std::vector<std::pair<glm::ivec3, engine::Chunk*>> requests;
+    for (size_t i = 0; i < coords.size(); i++) {
+        requests.emplace_back(coords[i], &chunks[i]);
+    }
+    engine::DecorationQueue decorations;
+    generator.generate(pool, requests, decorations);
+    return chunks;
+}
+
+template <typename Layout>
+bool isSameChunk(const engine::BasicChunk<Layout>& a, const engine::BasicChunk<Layout>& b) {
+    const int length = static_cast<int>(engine::CHUNK_LENGTH);
+    engine::BlockType rowA[engine::CHUNK_LENGTH];
+    engine::BlockType rowB[engine::CHUNK_LENGTH];
+    for (int z = 0; z < length; z++) {
+        for (int y = 0; y < length; y++) {
+            a.getRow(y, z, rowA);
+            b.getRow(y, z, rowB);
+            if (!std::equal(rowA, rowA + length, rowB)) return false;
+        }
+    }
+    return true;
+}
+
+template <typename Layout>
+void runBenchmark(const std::string& name, const std::vector<engine::Chunk>& source, bool compress) {
+    const int length = static_cast<int>(engine::CHUNK_LENGTH);
+    std::vector<engine::BasicChunk<Layout>> chunks(source.size());
+    engine::BlockType row[engine::CHUNK_LENGTH];
+    for (size_t i = 0; i < source.size(); i++) {
+        for (int z = 0; z < length; z++) {
+            for (int y = 0; y < length; y++) {
+                source[i].getRow(y, z, row);
+                chunks[i].setRow(y, z, row);
+            }
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> encoded(chunks.size());
+    const bench::Timing encodeTiming = bench::measure(ITERATIONS, [&]() {
+        for (size_t i = 0; i < chunks.size(); i++) {
+            engine::ChunkCodec::encode(chunks[i], encoded[i], compress);
+        }
+    });
+    std::vector<engine::BasicChunk<Layout>> decoded(chunks.size());
+    const bench::Timing decodeTiming = bench::measure(ITERATIONS, [&]() {
+        for (size_t i = 0; i < chunks.size(); i++) {
+            engine::ChunkCodec::decode(encoded[i].data(), encoded[i].size(), decoded[i]);
+        }
+    });
+
+    size_t encodedBytes = 0;
+    bool identical = true;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        encodedBytes += encoded[i].size();
+        identical = identical && isSameChunk(chunks[i], decoded[i]);
+    }
+    const double rawBytes = static_cast<double>(chunks.size() * engine::BasicChunk<Layout>::UNCOMPRESSED_SIZE);
+    std::cout << std::left << std::setw(8) << name << std::setw(8) << (compress ? "rle+lz" : "rle") << std::right
+              << " encode " << std::setw(7) << std::fixed << std::setprecision(0) << rawBytes / encodeTiming.best << " MB/s"
+              << "   decode " << std::setw(7) << rawBytes / decodeTiming.best << " MB/s"
+              << " (" << std::setprecision(1) << decodeTiming.best / chunks.size() << " us/chunk)"
+              << "   ratio " << std::setw(6) << rawBytes / encodedBytes << ":1"
+              << "   " << std::setw(6) << encodedBytes / chunks.size() << " B/chunk"
+              << (identical ? "" : "   MISMATCH") << "\n";
+}
+
+} // namespace
+
+int main() {
+    const std::vector<engine::Chunk> chunks = generateChunks();
+    std::cout << "ChunkCodec over " << chunks.size() << " generated chunks, best of " << ITERATIONS << "\n";
+    for (bool compress : {false, true}) {
+        runBenchmark<engine::LinearLayout>("linear", chunks, compress);
+        runBenchmark<engine::MortonLayout>("morton", chunks, compress);
+        runBenchmark<engine::BrickLayout>("brick", chunks, compress);
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+// Chunk reads from a region file as the streamer issues them: in random order, BATCH per
+// submission, each batch once the previous one is done. Compares reading through the mapping
+// one chunk at a time (page faults on the calling thread) with AsyncFileIo on each backend, by
+// throughput and by the latency of each read from its submission. Cold runs drop the file
+// from the page cache first (Linux only; elsewhere, and on tmpfs, they stay warm).
+
+#include <async_file_io.hpp>
+#include <region_file.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int LAYERS = 4; // of RegionFile::LENGTH^2 chunks
+constexpr size_t BATCH = 64;
+constexpr size_t MIN_PAYLOAD = 512;  // the range of encoded generated chunks
+constexpr size_t MAX_PAYLOAD = 3072;
+
+const char* getBackendName(engine::IoBackend backend) {
+    switch (backend) {
+        case engine::IO_BACKEND_THREAD_POOL: return "pread";
+        case engine::IO_BACKEND_IO_URING: return "io_uring";
+    }
+    return "?";
+}
+
+std::vector<glm::ivec3> getCoords() {
+    std::vector<glm::ivec3> coords;
+    for (int y = 0; y < LAYERS; y++) {
+        for (int z = 0; z < engine::RegionFile::LENGTH; z++) {
+            for (int x = 0; x < engine::RegionFile::LENGTH; x++) {
+                coords.push_back({x, engine::RegionFile::MIN_CHUNK_Y + y, z});
+            }
+        }
+    }
+    std::shuffle(coords.begin(), coords.end(), std::mt19937{1337});
+    return coords;
+}
+
+void writeRegion(const std::string& path, const std::vector<glm::ivec3>& coords) {
+    std::filesystem::remove(path);
+    engine::RegionFile region{path};
+    std::mt19937 random{42};
+    std::uniform_int_distribution<size_t> sizes{MIN_PAYLOAD, MAX_PAYLOAD};
+    std::vector<uint8_t> payload;
+    for (const glm::ivec3& chunkCoord : coords) {
+        payload.resize(sizes(random));
+        for (uint8_t& byte : payload) {
+            byte = static_cast<uint8_t>(random());
+        }
+        region.write(chunkCoord, payload.data(), payload.size());
+    }
+    region.flush();
+}
+
+// Needs the region's pages unmapped, so call it before opening the region
+void dropCache(const std::string& path) {
+#ifdef __linux__
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) return;
+    posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(file);
+#else
+    (void)path;
+#endif
+}
+
+void report(const std::string& name, bool cold, std::vector<double>& latencies, double seconds) {
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](double p) { return latencies[static_cast<size_t>(p * (latencies.size() - 1))]; };
+    std::cout << std::left << std::setw(10) << name << std::setw(6) << (cold ? "cold" : "warm") << std::right
+              << std::fixed << std::setprecision(0)
+              << std::setw(9) << latencies.size() / seconds << " reads/s"
+              << "   p50 " << std::setw(7) << std::setprecision(1) << percentile(0.5) << " us"
+              << "   p99 " << std::setw(7) << percentile(0.99) << " us"
+              << "   max " << std::setw(8) << latencies.back() << " us\n";
+}
+
+double getMicroseconds(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+// One thread going through the batch, as the generation workers used to
+void runMapped(const std::string& path, const std::vector<glm::ivec3>& coords, bool cold) {
+    if (cold) dropCache(path);
+    engine::RegionFile region{path};
+    std::vector<double> latencies;
+    std::vector<uint8_t> buffer(MAX_PAYLOAD);
+    const Clock::time_point start = Clock::now();
+    for (size_t first = 0; first < coords.size(); first += BATCH) {
+        const Clock::time_point submitted = Clock::now();
+        const size_t last = std::min(first + BATCH, coords.size());
+        for (size_t i = first; i < last; i++) {
+            region.read(coords[i], [&](const uint8_t* data, size_t size) { std::copy(data, data + size, buffer.begin()); });
+            latencies.push_back(getMicroseconds(submitted, Clock::now()));
+        }
+    }
+    report("mapped", cold, latencies, getMicroseconds(start, Clock::now()) * 1e-6);
+}
+
+void runAsync(const std::string& path, const std::vector<glm::ivec3>& coords, engine::IoBackend backend, bool cold) {
+    if (cold) dropCache(path);
+    engine::RegionFile region{path};
+    engine::AsyncFileIo io{backend};
+    std::vector<double> latencies(coords.size());
+    std::vector<std::unique_ptr<uint8_t[]>> buffers(coords.size());
+    std::atomic<size_t> failures{0};
+    const Clock::time_point start = Clock::now();
+    for (size_t first = 0; first < coords.size(); first += BATCH) {
+        std::vector<engine::AsyncFileIo::Request> batch;
+        const Clock::time_point submitted = Clock::now();
+        for (size_t i = first; i < std::min(first + BATCH, coords.size()); i++) {
+            engine::RegionFile::Extent extent{};
+            region.beginRead(coords[i], extent);
+            buffers[i] = std::make_unique<uint8_t[]>(extent.size);
+            batch.push_back({region.getNativeFile(), extent.getOffset(), buffers[i].get(), extent.size, false,
+                [&, i, submitted, size = extent.size](int64_t result) {
+                    latencies[i] = getMicroseconds(submitted, Clock::now());
+                    if (result != static_cast<int64_t>(size)) failures++;
+                    region.endRead();
+                }});
+        }
+        io.submit(std::move(batch));
+        io.wait();
+    }
+    report(getBackendName(backend), cold, latencies, getMicroseconds(start, Clock::now()) * 1e-6);
+    if (failures > 0) std::cout << "  " << failures << " FAILED READS\n";
+}
+
+} // namespace
+
+int main() {
+    const std::string path = (std::filesystem::temp_directory_path() / "chunk_io_bench.region").string();
+    const std::vector<glm::ivec3> coords = getCoords();
+    writeRegion(path, coords);
+    std::cout << coords.size() << " chunk reads of " << MIN_PAYLOAD << " to " << MAX_PAYLOAD << " bytes, "
+              << BATCH << " per batch, best backend " << getBackendName(engine::AsyncFileIo::getBestBackend()) << "\n";
+    for (bool cold : {true, false}) {
+        runMapped(path, coords, cold);
+        for (engine::IoBackend backend : {engine::IO_BACKEND_THREAD_POOL, engine::IO_BACKEND_IO_URING}) {
+            if (!engine::AsyncFileIo::isBackendSupported(backend)) continue;
+            runAsync(path, coords, backend, cold);
+        }
+    }
+    std::filesystem::remove(path);
+    return 0;
+}
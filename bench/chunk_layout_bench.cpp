@@ -0,0 +1,60 @@
+// Compares 6-neighbor sweeps (the access pattern of face culling and light propagation)
+// across the chunk storage layouts.
+
+#include "bench_common.hpp"
+
+#include <chunk.hpp>
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+constexpr int ITERATIONS = 200;
+
+template <typename Layout>
+uint32_t sweepNeighbors(const engine::BasicChunk<Layout>& chunk) {
+    const int length = static_cast<int>(engine::CHUNK_LENGTH);
+    uint32_t exposedFaces = 0;
+    for (int z = 1; z < length - 1; z++) {
+        for (int y = 1; y < length - 1; y++) {
+            for (int x = 1; x < length - 1; x++) {
+                if (chunk.getBlockUnchecked(x, y, z) == engine::AIR) continue;
+                exposedFaces += chunk.getBlockUnchecked(x - 1, y, z) == engine::AIR;
+                exposedFaces += chunk.getBlockUnchecked(x + 1, y, z) == engine::AIR;
+                exposedFaces += chunk.getBlockUnchecked(x, y - 1, z) == engine::AIR;
+                exposedFaces += chunk.getBlockUnchecked(x, y + 1, z) == engine::AIR;
+                exposedFaces += chunk.getBlockUnchecked(x, y, z - 1) == engine::AIR;
+                exposedFaces += chunk.getBlockUnchecked(x, y, z + 1) == engine::AIR;
+            }
+        }
+    }
+    return exposedFaces;
+}
+
+template <typename Layout>
+void runBenchmark(const std::string& name) {
+    engine::BasicChunk<Layout> chunk{};
+    bench::generateTerrain(chunk);
+
+    uint32_t checksum = 0;
+    const bench::Timing timing = bench::measure(ITERATIONS, [&]() { checksum += sweepNeighbors(chunk); });
+
+    std::cout << std::left << std::setw(8) << name
+              << " best " << std::right << std::setw(9) << std::fixed << std::setprecision(1) << timing.best << " us"
+              << "   avg " << std::setw(9) << timing.average << " us"
+              << "   bits/block " << static_cast<int>(chunk.getBitsPerBlock())
+              << "   (checksum " << checksum << ")\n";
+}
+
+} // namespace
+
+int main() {
+    std::cout << "6-neighbor sweep over a 32^3 chunk, " << ITERATIONS << " iterations\n";
+    runBenchmark<engine::LinearLayout>("linear");
+    runBenchmark<engine::MortonLayout>("morton");
+    runBenchmark<engine::BrickLayout>("brick");
+    return 0;
+}
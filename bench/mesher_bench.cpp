@@ -0,0 +1,153 @@
+// Meshing time of one 32^3 chunk per meshing mode into FaceMesh records, as the worker pool
+// builds them, against the culled mesher as a baseline; the latency of a single block edit when
+// only the dirty sections are remeshed; and chunk throughput of the mesh worker pool as
+// workers are added.
+
+#include "bench_common.hpp"
+
+#include <chunk.hpp>
+#include <chunk_mesher.hpp>
+#include <mesh_worker_pool.hpp>
+#include <utils.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+constexpr int ITERATIONS = 200;
+constexpr int POOL_CHUNKS = 512;
+constexpr double TARGET_US = 100.0; // whole chunk in the default mode, on average
+
+struct ModeResult {
+    bench::Timing timing{};
+    uint32_t quadCount = 0;
+};
+
+ModeResult runBenchmark(const std::string& name, const engine::ChunkNeighborhood& neighborhood, engine::MeshingMode mode,
+    double baselineUs) {
+    engine::FaceMesh::Builder builder{};
+    engine::MeshStats stats{};
+    const bench::Timing timing = bench::measure(ITERATIONS, [&]() {
+        builder.faces.clear();
+        builder.translucentFaces.clear();
+        stats = engine::ChunkMesher::buildMesh(neighborhood, builder, mode);
+    });
+
+    std::cout << std::left << std::setw(8) << name
+              << " best " << std::right << std::setw(8) << std::fixed << std::setprecision(1) << timing.best << " us"
+              << "   avg " << std::setw(8) << timing.average << " us"
+              << "   p99 " << std::setw(8) << timing.p99 << " us"
+              << "   vs culled " << std::setw(5) << std::setprecision(2) << timing.average / (baselineUs > 0.0 ? baselineUs : timing.average)
+              << "x   quads " << std::setw(6) << stats.quadCount << "\n";
+    return {timing, stats.quadCount};
+}
+
+// One block toggled per iteration, then the dirty sections remeshed and the chunk mesh reassembled,
+// which is what the main thread and one worker do for an edit (minus the GPU upload)
+void runEditBenchmark(engine::Chunk chunk, const engine::ChunkNeighborhood::Neighbors& neighbors) {
+    engine::ChunkMeshSections sections{};
+    engine::ChunkNeighborhood neighborhood = engine::ChunkNeighborhood::gather(chunk, neighbors);
+    for (size_t section = 0; section < engine::Chunk::SECTION_COUNT; section++) {
+        engine::ChunkMesher::buildSectionMesh(neighborhood, sections.faces[section], section);
+    }
+    chunk.clearDirty();
+
+    const int length = static_cast<int>(engine::Chunk::LENGTH);
+    uint32_t seed = 12345;
+    int remeshedSections = 0;
+    engine::FaceMesh::Builder builder{};
+    const bench::Timing timing = bench::measure(ITERATIONS, [&]() {
+        seed = seed * 1664525u + 1013904223u;
+        const int x = static_cast<int>(seed >> 8) % length;
+        const int y = static_cast<int>(seed >> 16) % length;
+        const int z = static_cast<int>(seed >> 24) % length;
+        chunk.setBlock(x, y, z, chunk.getBlock(x, y, z) == engine::AIR ? engine::STONE : engine::AIR);
+
+        neighborhood = engine::ChunkNeighborhood::gather(chunk, neighbors);
+        for (uint64_t dirty = chunk.getDirtySections(); dirty != 0; dirty &= dirty - 1) {
+            const size_t section = engine::countTrailingZeros(dirty);
+            sections.faces[section].faces.clear();
+            engine::ChunkMesher::buildSectionMesh(neighborhood, sections.faces[section], section);
+            remeshedSections++;
+        }
+        chunk.clearDirty();
+
+        builder.faces.clear();
+        sections.assemble(builder);
+    });
+
+    std::cout << "edit     best " << std::right << std::setw(8) << std::fixed << std::setprecision(1) << timing.best << " us"
+              << "   avg " << std::setw(8) << timing.average << " us"
+              << "   p99 " << std::setw(8) << timing.p99 << " us"
+              << "   sections/edit " << std::setprecision(2) << static_cast<double>(remeshedSections) / ITERATIONS << "\n";
+}
+
+// Chunks per second through MeshWorkerPool, submitting from this thread like the renderer does
+void runPoolBenchmark(unsigned workerCount, const engine::Chunk& chunk, const engine::ChunkNeighborhood::Neighbors& neighbors) {
+    engine::MeshWorkerPool pool{true, workerCount};
+    engine::MeshResult result{};
+    int submitted = 0;
+    int completed = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    while (completed < POOL_CHUNKS) {
+        while (submitted < POOL_CHUNKS && pool.submitWhole({submitted, 0, 0}, engine::ChunkNeighborhood::gather(chunk, neighbors))) {
+            submitted++;
+        }
+        while (pool.tryPopResult(result)) {
+            completed++;
+        }
+        std::this_thread::yield();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "workers " << std::setw(2) << workerCount
+              << "   " << std::setw(8) << std::fixed << std::setprecision(0) << POOL_CHUNKS / seconds << " chunks/s\n";
+}
+
+} // namespace
+
+int main() {
+    engine::Chunk chunk{};
+    bench::generateTerrain(chunk);
+    const engine::Chunk stone{engine::STONE};
+    // The same terrain all around, stone below and air above
+    engine::ChunkNeighborhood::Neighbors neighbors{};
+    for (int dz = -1; dz <= 1; dz++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                neighbors[engine::Chunk::getNeighborIndex(dx, dy, dz)] = dy < 0 ? nullptr : (dy > 0 ? &stone : &chunk);
+            }
+        }
+    }
+    const engine::ChunkNeighborhood neighborhood = engine::ChunkNeighborhood::gather(chunk, neighbors);
+
+    std::cout << "Meshing a 32^3 terrain chunk into FaceMesh records, " << ITERATIONS << " iterations\n";
+    const ModeResult culled = runBenchmark("culled", neighborhood, engine::MESHING_CULLED, 0.0);
+    const ModeResult greedy = runBenchmark("greedy", neighborhood, engine::MESHING_GREEDY, culled.timing.average);
+    const ModeResult binary = runBenchmark("binary", neighborhood, engine::MESHING_BINARY, culled.timing.average);
+    const ModeResult& defaultMode = engine::ChunkMesher::DEFAULT_MODE == engine::MESHING_BINARY ? binary
+        : engine::ChunkMesher::DEFAULT_MODE == engine::MESHING_GREEDY ? greedy : culled;
+    // The time grows with the quads, and the pockets of this terrain leave about one visible
+    // face per solid block, many more than a surface chunk has; a miss says how many fit
+    const double usPerQuad = defaultMode.timing.average / std::max(defaultMode.quadCount, 1u);
+    std::cout << "target   avg under " << std::setprecision(0) << TARGET_US << " us in the default mode: "
+              << (defaultMode.timing.average < TARGET_US ? "met" : "missed") << ", " << std::setprecision(1)
+              << usPerQuad * 1000.0 << " ns per quad, so up to " << std::setprecision(0) << TARGET_US / usPerQuad
+              << " quads fit\n";
+
+    std::cout << "\nSingle block edits, dirty sections only (default mode)\n";
+    runEditBenchmark(chunk, neighbors);
+
+    std::cout << "\nMeshing " << POOL_CHUNKS << " chunks on the worker pool (default mode)\n";
+    for (unsigned workerCount = 1; workerCount <= engine::MeshWorkerPool::getDefaultWorkerCount(); workerCount *= 2) {
+        runPoolBenchmark(workerCount, chunk, neighbors);
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Time to fill a chunk's column plane (2D), block grid (3D) and block grid from a lattice
+// every 4 blocks (fillGridCoarse) with 4-octave fBm per noise type and backend, and a check
+// that every backend the CPU supports matches the scalar one bit for bit.
+
+#include "bench_common.hpp"
+
+#include <noise.hpp>
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int ITERATIONS = 50;
+constexpr uint32_t SEED = 1337;
+constexpr int COARSE_STEP = 4;
+
+const char* getBackendName(engine::NoiseBackend backend) {
+    switch (backend) {
+        case engine::NOISE_BACKEND_SSE41: return "sse4.1";
+        case engine::NOISE_BACKEND_AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+void runBenchmark(const std::string& name, const engine::NoiseSettings& settings, engine::NoiseBackend backend) {
+    const engine::Noise noise{SEED, backend};
+    const engine::Noise reference{SEED, engine::NOISE_BACKEND_SCALAR};
+    const size_t length = engine::CHUNK_LENGTH;
+    std::vector<float> out(length * length * length);
+    std::vector<float> expected(length * length * length);
+
+    int chunk = 0;
+    const bench::Timing plane = bench::measure(ITERATIONS, [&]() {
+        noise.fillPlane(settings, {chunk++ * 32, 0}, out.data());
+    });
+    const bench::Timing grid = bench::measure(ITERATIONS, [&]() {
+        noise.fillGrid(settings, {chunk++ * 32, 0, 0}, out.data());
+    });
+    const bench::Timing coarse = bench::measure(ITERATIONS, [&]() {
+        noise.fillGridCoarse(settings, {chunk++ * 32, 0, 0}, COARSE_STEP, out.data());
+    });
+
+    noise.fillGrid(settings, {-4096, 64, 4096}, out.data());
+    reference.fillGrid(settings, {-4096, 64, 4096}, expected.data());
+    bool identical = std::memcmp(out.data(), expected.data(), out.size() * sizeof(float)) == 0;
+    noise.fillGridCoarse(settings, {-4096, 64, 4096}, COARSE_STEP, out.data());
+    reference.fillGridCoarse(settings, {-4096, 64, 4096}, COARSE_STEP, expected.data());
+    identical = identical && std::memcmp(out.data(), expected.data(), out.size() * sizeof(float)) == 0;
+
+    std::cout << std::left << std::setw(8) << name << std::setw(7) << getBackendName(backend)
+              << " plane " << std::right << std::setw(8) << std::fixed << std::setprecision(1) << plane.best << " us"
+              << "   grid " << std::setw(9) << grid.best << " us"
+              << "   " << std::setprecision(2) << grid.best * 1000.0 / (out.size() * settings.octaves) << " ns/sample/octave"
+              << "   coarse " << std::setprecision(1) << std::setw(7) << coarse.best << " us"
+              << (identical ? "" : "   MISMATCH") << "\n";
+}
+
+} // namespace
+
+int main() {
+    engine::NoiseSettings settings{};
+    settings.octaves = 4;
+
+    std::cout << "Filling one chunk with " << settings.octaves << "-octave fBm, best of " << ITERATIONS << "\n";
+    for (engine::NoiseType type : {engine::NOISE_PERLIN, engine::NOISE_SIMPLEX}) {
+        settings.type = type;
+        for (engine::NoiseBackend backend : {engine::NOISE_BACKEND_SCALAR, engine::NOISE_BACKEND_SSE41, engine::NOISE_BACKEND_AVX2}) {
+            if (!engine::Noise::isBackendSupported(backend)) continue;
+            runBenchmark(type == engine::NOISE_PERLIN ? "perlin" : "simplex", settings, backend);
+        }
+    }
+    return 0;
+}
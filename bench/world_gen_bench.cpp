@@ -0,0 +1,97 @@
+// Time to generate the App's spawn area (16 x 2 x 16 chunks) on 1, 2, 4, ... threads of a
+// WorkStealingPool, and a check that every thread count produces the same blocks, decorations
+// included, as a single thread going through the chunks in reverse.
+
+#include "bench_common.hpp"
+
+#include <world_generator.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int ITERATIONS = 3;
+constexpr int GRID = 16;
+constexpr uint64_t SEED = 1337;
+
+std::vector<glm::ivec3> getSpawnArea() {
+    std::vector<glm::ivec3> coords;
+    for (int y = -1; y <= 0; y++) {
+        for (int z = 0; z < GRID; z++) {
+            for (int x = 0; x < GRID; x++) {
+                coords.push_back({x - GRID / 2, y, z - GRID / 2});
+            }
+        }
+    }
+    return coords;
+}
+
+bool isSameChunk(const engine::Chunk& a, const engine::Chunk& b) {
+    const int length = static_cast<int>(engine::CHUNK_LENGTH);
+    engine::BlockType rowA[engine::CHUNK_LENGTH];
+    engine::BlockType rowB[engine::CHUNK_LENGTH];
+    for (int z = 0; z < length; z++) {
+        for (int y = 0; y < length; y++) {
+            a.getRow(y, z, rowA);
+            b.getRow(y, z, rowB);
+            if (!std::equal(rowA, rowA + length, rowB)) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    const engine::WorldGenerator generator{SEED};
+    const std::vector<glm::ivec3> coords = getSpawnArea();
+
+    // Sequential, in the opposite order
+    std::vector<engine::Chunk> reference(coords.size());
+    engine::DecorationQueue referenceDecorations;
+    for (size_t i = coords.size(); i-- > 0;) {
+        generator.generate(coords[i], reference[i], referenceDecorations);
+    }
+    for (size_t i = 0; i < coords.size(); i++) {
+        referenceDecorations.apply(coords[i], reference[i]);
+    }
+
+    std::cout << "Generating " << coords.size() << " chunks, best of " << ITERATIONS << "\n";
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    double singleThread = 0.0;
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    for (unsigned threads : threadCounts) {
+        engine::WorkStealingPool pool{threads};
+        std::vector<engine::Chunk> chunks(coords.size());
+        std::vector<std::pair<glm::ivec3, engine::Chunk*>> requests;
+        for (size_t i = 0; i < coords.size(); i++) {
+            requests.emplace_back(coords[i], &chunks[i]);
+        }
+        const bench::Timing timing = bench::measure(ITERATIONS, [&]() {
+            engine::DecorationQueue decorations;
+            generator.generate(pool, requests, decorations);
+        });
+        if (threads == 1) singleThread = timing.best;
+
+        bool identical = true;
+        for (size_t i = 0; i < coords.size(); i++) {
+            identical = identical && isSameChunk(chunks[i], reference[i]);
+        }
+        std::cout << std::setw(3) << threads << " threads " << std::setw(9) << std::fixed << std::setprecision(1)
+                  << timing.best / 1000.0 << " ms   " << std::setw(6) << std::setprecision(2)
+                  << timing.best / 1000.0 / coords.size() << " ms/chunk   speedup "
+                  << singleThread / timing.best << "x" << (identical ? "" : "   MISMATCH") << "\n";
+    }
+    return 0;
+}
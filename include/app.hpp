@@ -6,9 +6,27 @@
 #include <device.hpp>
 #include <renderer.hpp>
 #include <game_object.hpp>
+#include <mesh_worker_pool.hpp>
+#include <upload_queue.hpp>
+#include <chunk.hpp>
+#include <chunk_lod.hpp>
+#include <chunk_mesher.hpp>
+#include <chunk_streamer.hpp>
+#include <work_stealing_pool.hpp>
+#include <world_generator.hpp>
+#include <world_storage.hpp>
 
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include <array>
 #include <memory>
 #include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace engine{
 
@@ -17,6 +35,45 @@ public:
     static constexpr uint32_t WIDTH = 800;
     static constexpr uint32_t HEIGHT = 600;
 
+    // Chunk terrain as face records pulled by the vertex shader (FaceRenderSystem) instead of
+    // packed vertex and index buffers (VoxelRenderSystem)
+    static constexpr bool TERRAIN_VERTEX_PULLING = true;
+    // Face mesh descriptor sets per pool; more pools are built as the loaded and retired meshes need
+    static constexpr uint32_t FACE_MESHES_PER_POOL = 1024;
+
+    // Finished chunk meshes turned into GPU buffers per frame; the rest wait for later frames.
+    // Their copies go to the GPU in one batch per frame.
+    static constexpr int MESH_UPLOADS_PER_FRAME = 4;
+
+    // Streaming budgets per frame: chunks sent to the generator (with at most
+    // MAX_GENERATIONS_IN_FLIGHT still generating), unloaded, and sent to the meshing workers
+    static constexpr size_t CHUNK_GENERATIONS_PER_FRAME = 8;
+    static constexpr size_t MAX_GENERATIONS_IN_FLIGHT = 32;
+    static constexpr size_t CHUNK_EVICTIONS_PER_FRAME = 8;
+    static constexpr int MESH_SUBMITS_PER_FRAME = 32;
+
+    // How far (in blocks of the mesh, so 2^level for LOD meshes) the camera moves before a
+    // chunk's translucent quads are re-sorted. Only chunks within TRANSLUCENT_SORT_RADIUS blocks
+    // (to their center) are re-sorted, at most TRANSLUCENT_SORTS_PER_FRAME of them per frame,
+    // nearest first; further out they keep the order of their last mesh.
+    static constexpr float TRANSLUCENT_SORT_DISTANCE = 1.f;
+    static constexpr float TRANSLUCENT_SORT_RADIUS = 96.f;
+    static constexpr size_t TRANSLUCENT_SORTS_PER_FRAME = 8;
+
+    // Sorted meshes applied per frame, after and on top of the mesh uploads. A re-sort only
+    // rewrites the translucent range of the mesh on screen.
+    static constexpr int SORTED_UPLOADS_PER_FRAME = 8;
+
+    // Chunks closer than this (in blocks, to their center) are meshed at full resolution; each
+    // doubling of the distance beyond it uses the next coarser ChunkLod level
+    static constexpr float LOD_DISTANCE = 64.f;
+
+    static constexpr uint64_t WORLD_SEED = 0x5eed;
+    // Where chunks are saved when they are unloaded; they are generated from WORLD_SEED until then
+    static constexpr const char* WORLD_DIRECTORY = "world";
+    // In WORLD_DIRECTORY: the tree blocks still waiting for chunks that were not loaded on exit
+    static constexpr const char* DECORATIONS_FILE = "decorations.bin";
+
     App();
     ~App();
 
@@ -25,16 +82,110 @@ public:
     App& operator=(const App&) = delete;
 
     void run();
+
+    // World block coordinates; blocks outside the loaded chunks are ignored. The sections the
+    // edit touches are remeshed once per frame, however many blocks changed.
+    void setBlock(glm::ivec3 blockPos, BlockType type);
 private:
+    struct LoadedChunk {
+        Chunk blocks{};
+        bool unsaved = true;       // differs from its copy in storage, or has none
+        ChunkMeshSections mesh{};
+        std::array<uint64_t, Chunk::SECTION_COUNT> sectionVersions{}; // MeshResult version of each section in mesh
+        uint64_t wholeVersion = 0; // MeshResult version of the one-piece mesh in section 0 of mesh, 0 once in sections
+        bool wholeSubmitted = false; // the last remesh of all sections was submitted in one piece
+        bool edited = false;       // reached by block edits since it was loaded, so kept in sections
+
+        bool hasTranslucent = false;
+        bool sortPending = false;  // only the SortJob with sortVersion may replace the mesh object
+        bool sortInPlace = false;  // that SortJob re-sorts the mesh on screen, rather than bringing a new one
+        uint64_t sortVersion = 0;
+        glm::vec3 sortOrigin{};    // view position of the last sort, in the mesh's own units
+
+        ChunkLod lod{};
+        int lodLevel = -1;         // level selected for the camera, -1 until the first selection
+        int shownLevel = 0;        // level of the mesh object on screen
+        uint8_t closedFaces = 0;   // bit per Face: neighbors at another level, walled off rather than meshed against
+        uint8_t sectionClosedFaces = 0; // closedFaces the sections in mesh were last submitted with
+        uint64_t staleSections = Chunk::ALL_SECTIONS; // sections of mesh edited while at a coarser level
+        uint64_t lodVersion = 0;   // MeshResult version of the LOD job that may replace the LOD mesh
+
+        uint64_t cacheKey = 0;        // content hash of the last full remesh submitted, 0 if the last one was partial
+        uint64_t cacheKeyVersion = 0; // MeshResult version of that remesh
+        FaceMesh::Builder lodFaces{};    // the last LOD mesh, kept for re-sorting
+        VoxelMesh::Builder lodVertices{};
+    };
+
+    // A chunk the generation workers decoded from storage or generated, for the main thread to add
+    struct GeneratedChunk {
+        glm::ivec3 chunkCoord{};
+        std::unique_ptr<Chunk> blocks{};
+        bool stored = false; // loaded from storage rather than generated
+    };
+
     void loadGameObjects();
+    void loadChunks(glm::vec3 spawnPosition);
+    void streamChunks(const ChunkStreamer::View& view);
+    void addGeneratedChunk(glm::ivec3 chunkCoord, Chunk&& blocks, bool stored);
+    void evictChunk(glm::ivec3 chunkCoord);
+    void remeshNeighbors(glm::ivec3 chunkCoord);
+    void updateLodLevels(glm::vec3 viewPosition);
+    void remeshDirtyChunks(const ChunkStreamer::View& view);
+    void uploadChunkMeshes(glm::vec3 viewPosition);
+
+    // Assembles the chunk mesh of the given level into the builder of the terrain format in use
+    void assembleChunkMesh(glm::ivec3 chunkCoord, const LoadedChunk& loaded, int level, SortJob& mesh) const;
+    void showChunkMesh(glm::ivec3 chunkCoord, LoadedChunk& loaded, int level, glm::vec3 viewPosition, uint64_t contentHash = 0);
+    bool showCachedMesh(glm::ivec3 chunkCoord, LoadedChunk& loaded, uint64_t contentHash);
+    bool submitTranslucentSort(SortJob&& mesh, LoadedChunk& loaded, glm::vec3 viewPosition);
+    void replaceChunkObject(const SortJob& mesh, uint64_t contentHash = 0);
+    void updateTranslucentOrder(const SortJob& sorted);
+    void placeChunkObject(glm::ivec3 chunkCoord, int level, GameObject chunkObject);
+
+    const Chunk* findChunk(glm::ivec3 chunkCoord) const;
+    // Neighbors behind closedFaces are left out, so the chunk is meshed with walls there
+    ChunkNeighborhood::Neighbors getNeighbors(glm::ivec3 chunkCoord, uint8_t closedFaces = 0) const;
+    LodNeighborhood::Neighbors getLodNeighbors(glm::ivec3 chunkCoord, uint8_t closedFaces) const;
 
     Window window{WIDTH, HEIGHT, "Voxel Engine"};
     Device device{window};
     Renderer renderer{window, device};
+    UploadQueue meshUploads{device};
 
     // note: order of declarations matters
     std::unique_ptr<DescriptorPool> globalPool{};
+    std::unique_ptr<DescriptorPoolManager> facePools{};
+    std::unique_ptr<DescriptorSetLayout> faceSetLayout{};
     GameObject::Map gameObjects;
+
+    std::unique_ptr<MeshWorkerPool> meshWorkers{};
+    const WorldGenerator worldGenerator{WORLD_SEED};
+    DecorationQueue decorations{}; // tree blocks waiting for chunks that are not loaded yet
+    ChunkStreamer chunkStreamer{}; // its default vertical extent, chunk layers -1 and 0, holds all of the generator's terrain
+    std::unordered_set<glm::ivec3> generatingChunks{};
+    std::mutex generatedMutex;     // guards generatedChunks, filled by the generation tasks
+    std::vector<GeneratedChunk> generatedChunks{};
+    WorldStorage storage{WORLD_DIRECTORY};
+    std::unique_ptr<WorkStealingPool> generationWorkers{}; // after what its tasks use, so it is destroyed (and drained) first
+    std::unordered_map<glm::ivec3, LoadedChunk> chunks{};
+    std::unordered_map<glm::ivec3, GameObject::id_t> chunkObjects{}; // chunk coordinate -> its mesh object
+    std::unordered_map<glm::ivec3, uint64_t> pendingRemesh{};        // sections still to submit when the job queue was full
+    uint64_t nextSortVersion = 1;
+
+    // Meshes of whole chunks without translucent quads, by ChunkNeighborhood::getContentHash.
+    // Chunks with identical neighborhoods share one mesh, each drawn at its own origin; an
+    // entry lapses once the last chunk object holding its mesh is gone.
+    struct CachedMesh {
+        std::weak_ptr<FaceMesh> faceMesh;
+        std::weak_ptr<VoxelMesh> voxelMesh;
+    };
+    std::unordered_map<uint64_t, CachedMesh> meshCache{};
+    const Chunk bedrock{STONE}; // below the bottom chunk layer
+    ChunkLod bedrockLod{};
+
+    // Replaced chunk objects stay alive until the frames that may still draw them have finished
+    std::vector<std::pair<uint64_t, GameObject>> retiredChunkObjects{}; // (frame retired at, object)
+    uint64_t frameCounter = 0;
 };
 
 } // namespace engine
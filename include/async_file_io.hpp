@@ -0,0 +1,99 @@
+#ifndef __ASYNC_FILE_IO_HPP__
+#define __ASYNC_FILE_IO_HPP__
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine {
+
+enum IoBackend : uint8_t {
+    IO_BACKEND_THREAD_POOL = 0, // blocking pread / pwrite on a few threads of its own
+    IO_BACKEND_IO_URING = 1     // Linux 5.7+
+};
+
+// Positional reads and writes on open files, submitted in batches and completed off the
+// calling thread, so threads doing CPU work never block on the disk. With io_uring a batch
+// is handed to the kernel in one system call and one thread reaps the completions; the
+// fallback runs blocking calls on its own threads. Completion callbacks run on those I/O
+// threads and should only hand the data on (to a WorkStealingPool, say); like pool tasks
+// they must not throw. Thread-safe.
+class AsyncFileIo {
+public:
+#ifdef _WIN32
+    using NativeFile = void*; // HANDLE
+#else
+    using NativeFile = int;
+#endif
+
+    // Bytes transferred, or a negative errno; a read short of the requested size reached the
+    // end of the file. Both backends go on after a short transfer until the range is done.
+    using Completion = std::function<void(int64_t result)>;
+
+    struct Request {
+        NativeFile file{};
+        uint64_t offset = 0;
+        uint8_t* buffer = nullptr; // read into or written from; must stay valid until completion
+        size_t size = 0;
+        bool write = false;
+        Completion done;
+    };
+
+    static constexpr unsigned DEFAULT_QUEUE_DEPTH = 256; // requests in flight with io_uring
+    static constexpr unsigned FALLBACK_THREADS = 4;
+    static constexpr size_t MAX_REQUEST_SIZE = 0x7ffff000; // Linux's limit for one read or write
+
+    explicit AsyncFileIo(IoBackend backend = getBestBackend(), unsigned queueDepth = DEFAULT_QUEUE_DEPTH);
+    ~AsyncFileIo(); // completes every request first
+
+    AsyncFileIo(const AsyncFileIo&) = delete;
+    AsyncFileIo& operator=(const AsyncFileIo&) = delete;
+
+    // With io_uring the whole batch goes to the kernel in one system call, and this blocks
+    // while queueDepth requests are in flight
+    void submit(std::vector<Request>&& batch);
+
+    // Blocks until every request submitted so far has completed and its callback returned.
+    // Must not be called from a completion callback.
+    void wait();
+
+    IoBackend getBackend() const { return backend; }
+
+    static bool isBackendSupported(IoBackend backend);
+    static IoBackend getBestBackend();
+
+private:
+    struct Ring; // io_uring state
+
+    // A request on the ring, with what it has transferred so far
+    struct RingRequest {
+        Request request;
+        size_t transferred = 0;
+    };
+
+    void submitToRing(std::vector<Request>& batch, std::unique_lock<std::mutex>& lock);
+    void reapLoop();
+    void fallbackLoop();
+    void complete(Request& request, int64_t result);
+
+    const IoBackend backend;
+    std::unique_ptr<Ring> ring;
+    std::vector<std::thread> threads; // the reaper, or the fallback workers
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;   // fallback workers: requests queued or stopping
+    std::condition_variable finished; // a request completed
+    std::deque<Request> queued;       // fallback only
+    size_t inFlight = 0;              // submitted and not completed
+    bool stopping = false;
+};
+
+} // namespace engine
+
+#endif
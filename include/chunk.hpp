@@ -1,6 +1,10 @@
 #ifndef __CHUNK_HPP__
 #define __CHUNK_HPP__
 
+#include <chunk_layout.hpp>
+
+#include <array>
+#include <cassert>
 #include <cstdint>
 #include <stdexcept>
 #include <vector>
@@ -12,38 +16,263 @@ enum BlockType : uint8_t {
     DIRT    = 1,
     GRASS   = 2,
     STONE   = 3,
+    WATER   = 4,
+    GLASS   = 5,
+    LOG     = 6,
+    LEAVES  = 7,
     NUMBER_OF_TYPES
 };
 
-class Chunk {
+inline bool isSolid(BlockType type) { return type != AIR; }
+
+// Drawn in the blended pass after all opaque geometry
+inline bool isTranslucent(BlockType type) { return type == WATER || type == GLASS; }
+
+// Solid blocks that let light and sight through are solid but not opaque
+inline bool isOpaque(BlockType type) { return isSolid(type) && !isTranslucent(type); }
+
+enum Axis : uint8_t {
+    AXIS_X = 0,
+    AXIS_Y = 1,
+    AXIS_Z = 2
+};
+
+// Block faces; face / 2 is the axis and face % 2 the direction (0: negative, 1: positive)
+enum Face : uint8_t {
+    FACE_NEG_X = 0,
+    FACE_POS_X = 1,
+    FACE_NEG_Y = 2,
+    FACE_POS_Y = 3,
+    FACE_NEG_Z = 4,
+    FACE_POS_Z = 5,
+    NUMBER_OF_FACES
+};
+
+// Blocks are stored as indices into a per-chunk palette, bit-packed into 64-bit words.
+// The index width grows 1 -> 2 -> 4 -> 8 bits as new block types are added, so a chunk
+// holding two or three types costs 4-8 KiB instead of 32 KiB.
+// A chunk made of a single block type (all AIR, all STONE) is "uniform": it owns no heap
+// storage until the first setBlock that breaks the uniformity.
+// Layout selects the voxel storage order at compile time (see chunk_layout.hpp).
+//
+// Solid and opaque occupancy is also kept as 32-bit column masks in all three axis
+// orientations, updated incrementally on every write, so face visibility and collision
+// can be answered with shifts and ANDs over 1024 words.
+//
+// Writes also mark the SECTION_LENGTH^3 sections whose meshes they can change, so a block
+// edit only remeshes a few sections instead of the whole chunk (and its neighbors).
+template <typename Layout>
+class BasicChunk {
 public:
-    static constexpr size_t LENGTH = 32;
+    static constexpr size_t LENGTH = CHUNK_LENGTH;
     static constexpr size_t SIZE = LENGTH * LENGTH * LENGTH;
+    static constexpr size_t UNCOMPRESSED_SIZE = SIZE * sizeof(BlockType);
+    static constexpr size_t COLUMNS = LENGTH * LENGTH; // column masks per axis
+    static constexpr size_t SECTION_LENGTH = 8;
+    static constexpr size_t SECTIONS_PER_AXIS = LENGTH / SECTION_LENGTH;
+    static constexpr size_t SECTION_COUNT = SECTIONS_PER_AXIS * SECTIONS_PER_AXIS * SECTIONS_PER_AXIS;
+    static constexpr uint64_t ALL_SECTIONS = ~uint64_t{0} >> (64 - SECTION_COUNT);
+
+    static_assert(SECTION_COUNT <= 64, "dirty sections must fit one 64-bit mask");
 
-    Chunk() : blocks{SIZE, AIR} {}
+    // The chunk itself and the 26 chunks around it, by offset -1..1 along each axis
+    static constexpr size_t NEIGHBOR_COUNT = 27;
+    static size_t getNeighborIndex(int dx, int dy, int dz) { return (dx + 1) + (dy + 1) * 3 + (dz + 1) * 9; }
+
+    explicit BasicChunk(BlockType type = AIR) : uniformBlock{type} {}
 
     // Helper to get index in the 1D array
-    size_t getIndex(uint8_t x, uint8_t y, uint8_t z) const {
-        return x + (y * LENGTH) + (z * LENGTH * LENGTH);
+    size_t getIndex(int x, int y, int z) const {
+        return Layout::index(x, y, z);
     }
 
-    BlockType getBlock(uint8_t x, uint8_t y, uint8_t z) const {
-        if (x < 0 || x >= LENGTH || y < 0 || y >= LENGTH || z < 0 || z >= LENGTH) {
+    static bool inBounds(int x, int y, int z) {
+        return x >= 0 && x < static_cast<int>(LENGTH)
+            && y >= 0 && y < static_cast<int>(LENGTH)
+            && z >= 0 && z < static_cast<int>(LENGTH);
+    }
+
+    BlockType getBlock(int x, int y, int z) const {
+        if (!inBounds(x, y, z)) {
             throw std::runtime_error("Access violation: getBlock(int,int,int) index out of bounds!");
         }
-        return blocks[getIndex(x, y, z)];
+        return getBlockUnchecked(x, y, z);
     }
 
     void setBlock(int x, int y, int z, BlockType type) {
-        if (x < 0 || x >= LENGTH || y < 0 || y >= LENGTH || z < 0 || z >= LENGTH) {
+        if (!inBounds(x, y, z)) {
             throw std::runtime_error("Access violation: setBlock(int,int,int,BlockType) index out of bounds!");
         }
-        blocks[getIndex(x, y, z)] = type;
+        setBlockUnchecked(x, y, z, type);
+    }
+
+    // Unchecked accessors for generator and mesher inner loops. Coordinates must be in [0, LENGTH).
+    BlockType getBlockUnchecked(int x, int y, int z) const {
+        assert(inBounds(x, y, z) && "getBlockUnchecked index out of bounds");
+        if (isUniform()) return uniformBlock;
+        return palette[readPaletteIndex(getIndex(x, y, z))];
+    }
+
+    void setBlockUnchecked(int x, int y, int z, BlockType type) {
+        assert(inBounds(x, y, z) && "setBlockUnchecked index out of bounds");
+        if (isUniform()) {
+            if (type == uniformBlock) return;
+            expandUniform();
+        }
+        const size_t index = getIndex(x, y, z);
+        const BlockType oldType = palette[readPaletteIndex(index)];
+        if (oldType == type) return;
+        writePaletteIndex(index, findOrAddPaletteEntry(type));
+        updateOccupancy(x, y, z, oldType, type);
+        markDirty(x, y, z, x + 1, y + 1, z + 1);
+    }
+
+    // Bulk operations. Boxes are given as inclusive min / exclusive max corners and are
+    // processed a packed word at a time along the contiguous x runs of the layout.
+    void fill(int minX, int minY, int minZ, int maxX, int maxY, int maxZ, BlockType type);
+    void copyFrom(const BasicChunk& src, int srcX, int srcY, int srcZ, int dstX, int dstY, int dstZ, int sizeX, int sizeY, int sizeZ);
+
+    // Read / write LENGTH blocks along x (row) or y (column) through a caller buffer.
+    void getRow(int y, int z, BlockType* out) const;
+    void setRow(int y, int z, const BlockType* in);
+    void getColumn(int x, int z, BlockType* out) const;
+
+    // Sets every block to type and releases the packed storage. A chunk already uniform in
+    // type is left as it is, dirty sections included.
+    void fill(BlockType type);
+
+    // Drops palette entries no longer referenced by any block and shrinks the index width.
+    // A chunk left with a single block type becomes uniform again. Only the storage changes,
+    // so no section is marked dirty.
+    void compact();
+
+    // The packed storage as bytes, for serialization. Indices are in storage order
+    // (Layout::index); a uniform chunk reads as a one-entry palette and all-zero indices.
+    BlockType getPaletteEntry(size_t i) const { return isUniform() ? uniformBlock : palette[i]; }
+    void getPaletteIndices(uint8_t* out) const; // SIZE indices
+    // Replaces every block. The palette holds 1 to 256 distinct types and every index is
+    // below paletteSize.
+    void setPaletteIndices(const BlockType* types, size_t paletteSize, const uint8_t* indices);
+
+    // Uniform chunks can be skipped by meshing, lighting and upload
+    bool isUniform() const { return bitsPerBlock == 0; }
+    bool isEmpty() const { return isUniform() && uniformBlock == AIR; }
+
+    // Occupancy column masks. Bit i is set when the block at coordinate i along axis is
+    // solid (opaque). Columns are addressed by the two remaining coordinates (u, v):
+    // AXIS_X -> (y, z), AXIS_Y -> (x, z), AXIS_Z -> (x, y).
+    static size_t getColumnIndex(int u, int v) { return u + v * LENGTH; }
+
+    uint32_t getSolidColumn(Axis axis, int u, int v) const {
+        if (isUniform()) return isSolid(uniformBlock) ? ~0u : 0u;
+        return solidMasks[axis * COLUMNS + getColumnIndex(u, v)];
+    }
+
+    uint32_t getOpaqueColumn(Axis axis, int u, int v) const {
+        if (isUniform()) return isOpaque(uniformBlock) ? ~0u : 0u;
+        const std::vector<uint32_t>& masks = opaqueMasks.empty() ? solidMasks : opaqueMasks;
+        return masks[axis * COLUMNS + getColumnIndex(u, v)];
     }
+
+    // All COLUMNS masks of one orientation, indexed by getColumnIndex
+    const uint32_t* getSolidColumns(Axis axis) const;
+    const uint32_t* getOpaqueColumns(Axis axis) const;
+
+    // Sections are indexed by getSectionIndex of their section coordinates (block / SECTION_LENGTH).
+    // A write marks every section the box grown by one block overlaps, since a block also
+    // decides the faces and ambient occlusion of the blocks around it. Where the grown box
+    // reaches into a neighboring chunk (across a face, an edge or a corner), the sections of
+    // that chunk it overlaps are recorded as well. Flags accumulate until clearDirty().
+    static size_t getSectionIndex(int sx, int sy, int sz) {
+        return sx + sy * SECTIONS_PER_AXIS + sz * SECTIONS_PER_AXIS * SECTIONS_PER_AXIS;
+    }
+
+    bool isDirty() const { return getDirtySections() != 0; }
+    uint64_t getDirtySections() const { return dirtySections[getNeighborIndex(0, 0, 0)]; }
+    // Sections of the chunk at offset (dx, dy, dz) that writes to this chunk require remeshing
+    uint64_t getDirtyNeighborSections(int dx, int dy, int dz) const { return dirtySections[getNeighborIndex(dx, dy, dz)]; }
+    void clearDirty() { dirtySections.fill(0); }
+
+    // Memory counters
+    uint8_t getBitsPerBlock() const { return bitsPerBlock; }
+    size_t getPaletteSize() const { return isUniform() ? 1 : palette.size(); }
+    size_t getMemoryUsage() const; // bytes owned by this chunk, including heap storage
+
 private:
-    std::vector<BlockType> blocks;
+    static constexpr size_t WORD_BITS = 64;
+
+    uint32_t readPaletteIndex(size_t index) const {
+        const size_t bit = index * bitsPerBlock;
+        return static_cast<uint32_t>((data[bit / WORD_BITS] >> (bit % WORD_BITS)) & indexMask());
+    }
+
+    void writePaletteIndex(size_t index, uint32_t paletteIndex) {
+        const size_t bit = index * bitsPerBlock;
+        uint64_t& word = data[bit / WORD_BITS];
+        const size_t shift = bit % WORD_BITS;
+        word = (word & ~(indexMask() << shift)) | (static_cast<uint64_t>(paletteIndex) << shift);
+    }
+
+    uint64_t indexMask() const { return (uint64_t{1} << bitsPerBlock) - 1; }
+
+    uint32_t findOrAddPaletteEntry(BlockType type) {
+        for (size_t i = 0; i < palette.size(); i++) {
+            if (palette[i] == type) return static_cast<uint32_t>(i);
+        }
+        return addPaletteEntry(type);
+    }
+
+    uint64_t broadcast(uint32_t paletteIndex) const { return paletteIndex * (~uint64_t{0} / indexMask()); }
+    void writeRun(size_t first, size_t count, uint32_t paletteIndex);
+    void readPaletteIndices(size_t first, size_t count, uint8_t* out) const;
+
+    // Row helpers that split [x, x + count) into the contiguous runs of the layout
+    void writeRowRun(int x, int y, int z, int count, uint32_t paletteIndex);
+    void readRowPaletteIndices(int x, int y, int z, int count, uint8_t* out) const;
+
+    void updateOccupancy(int x, int y, int z, BlockType oldType, BlockType newType) {
+        if (isSolid(oldType) != isSolid(newType)) toggleColumnBits(solidMasks, x, y, z);
+        if (!opaqueMasks.empty() && isOpaque(oldType) != isOpaque(newType)) toggleColumnBits(opaqueMasks, x, y, z);
+    }
+
+    static void toggleColumnBits(std::vector<uint32_t>& masks, int x, int y, int z) {
+        masks[AXIS_X * COLUMNS + getColumnIndex(y, z)] ^= 1u << x;
+        masks[AXIS_Y * COLUMNS + getColumnIndex(x, z)] ^= 1u << y;
+        masks[AXIS_Z * COLUMNS + getColumnIndex(x, y)] ^= 1u << z;
+    }
+
+    void markDirty(int minX, int minY, int minZ, int maxX, int maxY, int maxZ);
+
+    static void setColumnBits(std::vector<uint32_t>& masks, int minX, int minY, int minZ, int maxX, int maxY, int maxZ, bool value);
+    void fillOccupancy(int minX, int minY, int minZ, int maxX, int maxY, int maxZ, BlockType type);
+    void refreshOccupancy(int minX, int minY, int minZ, int maxX, int maxY, int maxZ);
+    // All masks, for the blocks whose palette index is set in set
+    void buildOccupancy(std::vector<uint32_t>& masks, const uint8_t* indices, const std::array<bool, 256>& set);
+
+    uint32_t addPaletteEntry(BlockType type);
+    void expandUniform();
+    void releaseStorage(BlockType type); // uniform in type, without marking anything dirty
+    void repack(uint8_t newBitsPerBlock, const std::vector<uint32_t>& remap);
+
+    std::vector<BlockType> palette;
+    std::vector<uint64_t> data;
+    uint8_t bitsPerBlock {0};
+    BlockType uniformBlock;
+
+    // 3 * COLUMNS masks each, empty while the chunk is uniform. opaqueMasks stays empty
+    // (and mirrors solidMasks) until a solid, non-opaque type enters the palette.
+    std::vector<uint32_t> solidMasks;
+    std::vector<uint32_t> opaqueMasks;
+
+    std::array<uint64_t, NEIGHBOR_COUNT> dirtySections{}; // by getNeighborIndex
 };
 
+extern template class BasicChunk<LinearLayout>;
+extern template class BasicChunk<MortonLayout>;
+extern template class BasicChunk<BrickLayout>;
+
+using Chunk = BasicChunk<ENGINE_CHUNK_LAYOUT>;
+
 } // namespace engine
 
-#endif
\ No newline at end of file
+#endif
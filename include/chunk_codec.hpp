@@ -0,0 +1,35 @@
+#ifndef __CHUNK_CODEC_HPP__
+#define __CHUNK_CODEC_HPP__
+
+#include <chunk.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine {
+
+// Serialized chunks, for disk (WorldStorage), cold storage in memory and transfer. A chunk is
+// written as its palette followed by the runs of equal palette indices in storage order
+// (varint length, index byte), so air above the surface and stone below it cost a few bytes
+// per run rather than a byte per block. Optionally the whole body then goes through a small
+// LZ77 pass (LZ4-style sequences, 64 KiB window) that picks up what repeats between runs,
+// such as the rows of flat ground; it is only kept when it is smaller.
+//
+// The layout a chunk was encoded with is recorded, so any build decodes any chunk; a layout
+// other than the chunk's own costs a reordering pass. Decoding checks every length and index
+// and throws std::runtime_error on malformed input.
+class ChunkCodec {
+public:
+    static constexpr uint8_t VERSION = 1;
+
+    template <typename Layout>
+    static void encode(const BasicChunk<Layout>& chunk, std::vector<uint8_t>& out, bool compress = true);
+
+    template <typename Layout>
+    static void decode(const uint8_t* data, size_t size, BasicChunk<Layout>& chunk);
+};
+
+} // namespace engine
+
+#endif
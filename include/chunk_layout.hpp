@@ -0,0 +1,62 @@
+#ifndef __CHUNK_LAYOUT_HPP__
+#define __CHUNK_LAYOUT_HPP__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace engine {
+
+// Storage orders for the 32^3 voxels of a chunk. Each layout maps (x, y, z) to a storage
+// index and reports how many consecutive x values stay contiguous in storage (RUN_LENGTH),
+// which is what the bulk row operations of BasicChunk work on.
+constexpr size_t CHUNK_LENGTH = 32;
+
+// x-major: +x is 1 apart, +y is 32 apart, +z is 1024 apart.
+struct LinearLayout {
+    static constexpr uint8_t ID = 0; // recorded by ChunkCodec
+    static constexpr size_t RUN_LENGTH = CHUNK_LENGTH;
+
+    static size_t index(int x, int y, int z) {
+        return x + (y * CHUNK_LENGTH) + (z * CHUNK_LENGTH * CHUNK_LENGTH);
+    }
+};
+
+// Z-order curve: the bits of x, y and z are interleaved (x in the lowest bit), so every
+// aligned 2^n cube is contiguous.
+struct MortonLayout {
+    static constexpr uint8_t ID = 1;
+    static constexpr size_t RUN_LENGTH = 2;
+
+    static size_t index(int x, int y, int z) {
+        return spread(x) | (spread(y) << 1) | (spread(z) << 2);
+    }
+
+    // Moves bit i of a 5-bit coordinate to bit 3 * i
+    static size_t spread(int v) {
+        const size_t u = static_cast<size_t>(v);
+        return (u & 0x01) | ((u & 0x02) << 2) | ((u & 0x04) << 4) | ((u & 0x08) << 6) | ((u & 0x10) << 8);
+    }
+};
+
+// 8x8x8 bricks of 4x4x4 voxels, each brick stored x-major and contiguous (64 voxels).
+struct BrickLayout {
+    static constexpr uint8_t ID = 2;
+    static constexpr size_t BRICK_LENGTH = 4;
+    static constexpr size_t BRICKS_PER_AXIS = CHUNK_LENGTH / BRICK_LENGTH;
+    static constexpr size_t RUN_LENGTH = BRICK_LENGTH;
+
+    static size_t index(int x, int y, int z) {
+        const size_t brick = (x >> 2) + ((y >> 2) * BRICKS_PER_AXIS) + ((z >> 2) * BRICKS_PER_AXIS * BRICKS_PER_AXIS);
+        const size_t local = (x & 3) + ((y & 3) * BRICK_LENGTH) + ((z & 3) * BRICK_LENGTH * BRICK_LENGTH);
+        return brick * BRICK_LENGTH * BRICK_LENGTH * BRICK_LENGTH + local;
+    }
+};
+
+} // namespace engine
+
+// Layout used by engine::Chunk; override with -DENGINE_CHUNK_LAYOUT=MortonLayout or BrickLayout
+#ifndef ENGINE_CHUNK_LAYOUT
+#define ENGINE_CHUNK_LAYOUT LinearLayout
+#endif
+
+#endif
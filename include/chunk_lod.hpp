@@ -0,0 +1,65 @@
+#ifndef __CHUNK_LOD_HPP__
+#define __CHUNK_LOD_HPP__
+
+#include <chunk.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace engine {
+
+// Downsampled copies of a chunk for distant terrain. Level L has (LENGTH >> L)^3 cells of
+// 2^L blocks on a side; level 0 is the chunk itself and is not stored here. A cell takes the
+// solid type that fills most of the 8 cells below it, or AIR when fewer than half of them
+// are solid, so thin features thin out rather than thicken as the level grows. Ties go to
+// the type seen first from the top (-y), which keeps grass on top of dirt.
+class ChunkLod {
+public:
+    static constexpr int LEVELS = 4; // full resolution, then 2x, 4x and 8x coarser
+
+    static_assert((Chunk::SECTION_LENGTH >> (LEVELS - 1)) >= 1, "a section must cover whole cells at every level");
+
+    static int getLength(int level) { return static_cast<int>(Chunk::LENGTH) >> level; }
+    static float getScale(int level) { return static_cast<float>(1 << level); }
+
+    // Rebuilds every level from the chunk
+    void build(const Chunk& chunk);
+
+    // Rebuilds only the cells covering the given sections (Chunk::getSectionIndex bits), which
+    // is all a write can change; pass the chunk's dirty sections before they are cleared
+    void update(const Chunk& chunk, uint64_t sections);
+
+    // level in [1, LEVELS), cell coordinates in [0, getLength(level))
+    BlockType getCell(int level, int x, int y, int z) const {
+        const int length = getLength(level);
+        return cells[level][x + (y + z * length) * length];
+    }
+
+private:
+    // Cells in [min, max) of the level, in that level's cell coordinates
+    void reduceChunk(const Chunk& chunk, int minX, int minY, int minZ, int maxX, int maxY, int maxZ);
+    void reduceLevel(int level, int minX, int minY, int minZ, int maxX, int maxY, int maxZ);
+
+    std::array<std::vector<BlockType>, LEVELS> cells{}; // [0] stays empty
+};
+
+// One level of a chunk's mip chain with a one-cell shell from the same level of its
+// neighbors, which is everything meshing that level looks at. As for ChunkNeighborhood,
+// missing neighbors count as AIR.
+struct LodNeighborhood {
+    using Neighbors = std::array<const ChunkLod*, Chunk::NEIGHBOR_COUNT>; // by Chunk::getNeighborIndex
+
+    int level = 1;
+    std::vector<BlockType> cells{}; // getSize()^3, x fastest; cell (x, y, z) of the chunk at (x + 1, y + 1, z + 1)
+
+    int getSize() const { return ChunkLod::getLength(level) + 2; }
+    BlockType getCell(int x, int y, int z) const { return cells[x + (y + z * getSize()) * getSize()]; }
+
+    // The center entry of neighbors is ignored
+    static LodNeighborhood gather(const ChunkLod& lod, const Neighbors& neighbors, int level);
+};
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef __CHUNK_MESHER_HPP__
+#define __CHUNK_MESHER_HPP__
+
+#include <chunk.hpp>
+#include <chunk_lod.hpp>
+#include <model.hpp>
+#include <voxel_mesh.hpp>
+#include <face_mesh.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace engine {
+
+enum MeshingMode : uint8_t {
+    MESHING_CULLED = 0, // one quad per exposed block face
+    MESHING_GREEDY = 1, // coplanar faces of the same block type merged into maximal rectangles
+    MESHING_BINARY = 2  // same quads as MESHING_GREEDY, found with bitwise ops on the column masks
+};
+
+// A chunk together with the layer of blocks just outside each of its six faces, which is
+// everything face culling needs to look at, plus the opacity of the blocks just outside its
+// edges and corners, which ambient occlusion also reaches.
+struct ChunkNeighborhood {
+    using Slice = std::array<BlockType, Chunk::COLUMNS>;
+    using Neighbors = std::array<const Chunk*, Chunk::NEIGHBOR_COUNT>; // by Chunk::getNeighborIndex
+
+    static constexpr size_t NUMBER_OF_EDGES = 12;
+
+    const Chunk* chunk = nullptr;
+
+    // Indexed by Chunk::getColumnIndex(u, v) with (u, v) as for the column masks of the face axis
+    std::array<Slice, NUMBER_OF_FACES> borders{};
+
+    // Edge axis * 4 + su + 2 * sv, where su and sv tell which side (0: -1, 1: LENGTH) of the
+    // chunk the edge runs along on the (u, v) axes; bit i is the block at i along the edge axis
+    std::array<uint32_t, NUMBER_OF_EDGES> edgeOpacity{};
+    uint8_t cornerOpacity = 0; // bit sx + 2 * sy + 4 * sz, sides as for the edges
+
+    // Copies the border slices, edges and corners out of the neighbors; missing neighbors
+    // count as AIR. The center entry is ignored.
+    static ChunkNeighborhood gather(const Chunk& chunk, const Neighbors& neighbors);
+
+    // Hash of everything meshing in mode looks at: the chunk's blocks, the border slices, edges
+    // and corners, and the mode itself. Equal hashes give equal meshes, so it can key a mesh
+    // cache; it does not depend on how the chunk stores its blocks.
+    uint64_t getContentHash(MeshingMode mode) const;
+
+    // x, y, z in [-1, LENGTH] with at most one coordinate outside the chunk
+    BlockType getBlock(int x, int y, int z) const {
+        const int length = static_cast<int>(Chunk::LENGTH);
+        if (x < 0) return borders[FACE_NEG_X][Chunk::getColumnIndex(y, z)];
+        if (x >= length) return borders[FACE_POS_X][Chunk::getColumnIndex(y, z)];
+        if (y < 0) return borders[FACE_NEG_Y][Chunk::getColumnIndex(x, z)];
+        if (y >= length) return borders[FACE_POS_Y][Chunk::getColumnIndex(x, z)];
+        if (z < 0) return borders[FACE_NEG_Z][Chunk::getColumnIndex(x, y)];
+        if (z >= length) return borders[FACE_POS_Z][Chunk::getColumnIndex(x, y)];
+        return chunk->getBlockUnchecked(x, y, z);
+    }
+
+    // x, y, z in [-1, LENGTH], any number of them outside the chunk
+    bool isOpaqueAt(int x, int y, int z) const {
+        const int length = static_cast<int>(Chunk::LENGTH);
+        const int sideX = x < 0 ? 0 : (x >= length ? 1 : -1);
+        const int sideY = y < 0 ? 0 : (y >= length ? 1 : -1);
+        const int sideZ = z < 0 ? 0 : (z >= length ? 1 : -1);
+        const int outside = (sideX >= 0) + (sideY >= 0) + (sideZ >= 0);
+        if (outside == 0) return (chunk->getOpaqueColumn(AXIS_X, y, z) >> x) & 1u;
+        if (outside == 1) return isOpaque(getBlock(x, y, z));
+        if (outside == 3) return (cornerOpacity >> (sideX + 2 * sideY + 4 * sideZ)) & 1u;
+        if (sideX < 0) return (edgeOpacity[AXIS_X * 4 + sideY + 2 * sideZ] >> x) & 1u;
+        if (sideY < 0) return (edgeOpacity[AXIS_Y * 4 + sideX + 2 * sideZ] >> y) & 1u;
+        return (edgeOpacity[AXIS_Z * 4 + sideX + 2 * sideY] >> z) & 1u;
+    }
+};
+
+struct MeshStats {
+    uint32_t quadCount = 0;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+
+    MeshStats& operator+=(const MeshStats& other) {
+        quadCount += other.quadCount;
+        vertexCount += other.vertexCount;
+        indexCount += other.indexCount;
+        return *this;
+    }
+};
+
+// Per-section meshes of one chunk, kept on the CPU so a remesh only rebuilds the sections
+// that changed and the chunk mesh is reassembled from all of them. Only the builders of the
+// terrain format in use are filled. Translucent quads stay in their own range when assembled.
+struct ChunkMeshSections {
+    std::array<FaceMesh::Builder, Chunk::SECTION_COUNT> faces{};
+    std::array<VoxelMesh::Builder, Chunk::SECTION_COUNT> vertices{};
+
+    // Concatenates the sections in index order (vertex indices are rebased)
+    void assemble(FaceMesh::Builder& builder) const;
+    void assemble(VoxelMesh::Builder& builder) const;
+};
+
+// Turns voxel data into triangle meshes. Vertices are in chunk-local block units; the
+// chunk origin (getChunkOrigin) goes into the game object's transform.
+class ChunkMesher {
+public:
+    // Appends quads for the block faces not hidden by an opaque neighbor and reports what was
+    // added. Without a mode, DEFAULT_MODE is used. Terrain goes into a FaceMesh (one record per
+    // quad, vertex pulling) or a VoxelMesh (packed vertices); the Model overloads produce full
+    // float vertices for tools and debugging. Face records count as 4 vertices and 6 indices.
+    static MeshStats buildMesh(const ChunkNeighborhood& neighborhood, FaceMesh::Builder& builder, MeshingMode mode);
+    static MeshStats buildMesh(const ChunkNeighborhood& neighborhood, FaceMesh::Builder& builder) {
+        return buildMesh(neighborhood, builder, DEFAULT_MODE);
+    }
+    static MeshStats buildMesh(const ChunkNeighborhood& neighborhood, VoxelMesh::Builder& builder, MeshingMode mode);
+    static MeshStats buildMesh(const ChunkNeighborhood& neighborhood, VoxelMesh::Builder& builder) {
+        return buildMesh(neighborhood, builder, DEFAULT_MODE);
+    }
+    static MeshStats buildMesh(const ChunkNeighborhood& neighborhood, Model::Builder& builder, MeshingMode mode);
+    static MeshStats buildMesh(const ChunkNeighborhood& neighborhood, Model::Builder& builder) {
+        return buildMesh(neighborhood, builder, DEFAULT_MODE);
+    }
+
+    // Meshes only the blocks of one section (Chunk::getSectionIndex). Quads are cut at the
+    // section bounds, so the section meshes of a chunk can be rebuilt one at a time and
+    // concatenated into the chunk mesh (see ChunkMeshSections).
+    static MeshStats buildSectionMesh(const ChunkNeighborhood& neighborhood, FaceMesh::Builder& builder, size_t section, MeshingMode mode);
+    static MeshStats buildSectionMesh(const ChunkNeighborhood& neighborhood, FaceMesh::Builder& builder, size_t section) {
+        return buildSectionMesh(neighborhood, builder, section, DEFAULT_MODE);
+    }
+    static MeshStats buildSectionMesh(const ChunkNeighborhood& neighborhood, VoxelMesh::Builder& builder, size_t section, MeshingMode mode);
+    static MeshStats buildSectionMesh(const ChunkNeighborhood& neighborhood, VoxelMesh::Builder& builder, size_t section) {
+        return buildSectionMesh(neighborhood, builder, section, DEFAULT_MODE);
+    }
+
+    // Meshes one level of a chunk's mip chain (see ChunkLod) like a chunk whose blocks are its
+    // cells. Positions are in cells and start at 1, the shell cell before the chunk's first:
+    // the mesh goes to getLodOrigin and is scaled by ChunkLod::getScale.
+    static MeshStats buildLodMesh(const LodNeighborhood& neighborhood, FaceMesh::Builder& builder, MeshingMode mode);
+    static MeshStats buildLodMesh(const LodNeighborhood& neighborhood, FaceMesh::Builder& builder) {
+        return buildLodMesh(neighborhood, builder, DEFAULT_MODE);
+    }
+    static MeshStats buildLodMesh(const LodNeighborhood& neighborhood, VoxelMesh::Builder& builder, MeshingMode mode);
+    static MeshStats buildLodMesh(const LodNeighborhood& neighborhood, VoxelMesh::Builder& builder) {
+        return buildLodMesh(neighborhood, builder, DEFAULT_MODE);
+    }
+
+    // Reorders the translucent quads of a mesh back to front as seen from viewPosition (in
+    // chunk-local block units), which blending needs to composite them correctly. The opaque
+    // quads are left alone.
+    static void sortTranslucentFaces(FaceMesh::Builder& builder, glm::vec3 viewPosition);
+    static void sortTranslucentFaces(VoxelMesh::Builder& builder, glm::vec3 viewPosition);
+
+    // For the calls without a mode; MeshWorkerPool keeps its own default, which can be changed
+    // at runtime
+    static constexpr MeshingMode DEFAULT_MODE = MESHING_BINARY;
+
+    static glm::vec3 getChunkOrigin(glm::ivec3 chunkCoord) { return glm::vec3(chunkCoord) * static_cast<float>(Chunk::LENGTH); }
+    static glm::vec3 getLodOrigin(glm::ivec3 chunkCoord, int level) {
+        return getChunkOrigin(chunkCoord) - glm::vec3(ChunkLod::getScale(level));
+    }
+    static glm::vec3 getBlockColor(BlockType type);
+};
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef __CHUNK_RANDOM_HPP__
+#define __CHUNK_RANDOM_HPP__
+
+#define GLM_FORCE_CXX17
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace engine {
+
+// Counter-based random numbers for world generation. Value i of a stream is a pure function
+// of (world seed, chunk coordinate, stream, i): nothing is shared between chunks, so a chunk
+// comes out the same whichever thread generates it and whatever was generated before. Streams
+// keep the generation stages independent of each other (adding a draw to one stage does not
+// shift the numbers of the next).
+class ChunkRandom {
+public:
+    ChunkRandom(uint64_t worldSeed, glm::ivec3 chunkCoord, uint32_t stream)
+        : key{mix(mix(worldSeed ^ pack(chunkCoord.x, chunkCoord.z)) ^ pack(chunkCoord.y, static_cast<int32_t>(stream)))} {}
+
+    uint64_t next() { return mix(key + ++counter * GOLDEN_GAMMA); }
+
+    // Uniform in [0, bound), bound > 0
+    uint32_t nextInt(uint32_t bound) { return static_cast<uint32_t>(((next() >> 32) * bound) >> 32); }
+
+    // Uniform in [min, max]
+    int nextInt(int min, int max) { return min + static_cast<int>(nextInt(static_cast<uint32_t>(max - min + 1))); }
+
+    // Uniform in [0, 1), 24 bits
+    float nextFloat() { return static_cast<float>(next() >> 40) * (1.f / 16777216.f); }
+
+    // The splitmix64 finalizer: every input bit affects every output bit
+    static uint64_t mix(uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+
+private:
+    static constexpr uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ull;
+
+    static uint64_t pack(int32_t low, int32_t high) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(low)) | static_cast<uint64_t>(static_cast<uint32_t>(high)) << 32;
+    }
+
+    uint64_t key;
+    uint64_t counter = 0;
+};
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef __CHUNK_STREAMER_HPP__
+#define __CHUNK_STREAMER_HPP__
+
+#define GLM_FORCE_CXX17
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace engine {
+
+// Decides which chunks around the camera should be resident, in what order missing ones are
+// loaded and which ones are let go. Chunks within loadRadius of the camera, or of where the
+// camera is heading, are wanted; loaded chunks are only released beyond loadRadius +
+// unloadMargin, so flying back and forth across the edge does not load and evict the same
+// chunks over and over. It keeps no state of its own: the caller says what is loaded and
+// spends the results within its own per-frame budgets.
+class ChunkStreamer {
+public:
+    struct Settings {
+        float loadRadius = 10.f;     // in chunks, camera to chunk center
+        float unloadMargin = 2.f;    // in chunks, the hysteresis between loading and unloading
+        int minChunkY = -1;          // vertical extent of the world, in chunk coordinates
+        int maxChunkY = 0;
+        float prefetchSeconds = 1.5f; // how far ahead the camera velocity is extrapolated
+        float viewWeight = 0.5f;     // 0 to 1; how much chunks in front of the camera go first
+    };
+
+    struct View {
+        glm::vec3 position{};  // in blocks
+        glm::vec3 direction{0.f, 0.f, 1.f}; // unit length
+        glm::vec3 velocity{};  // in blocks per second
+    };
+
+    ChunkStreamer() = default;
+    explicit ChunkStreamer(const Settings& settings) : settings{settings} {}
+
+    // Lower is more urgent: the distance to where the camera will be, shortened by up to
+    // viewWeight for chunks straight ahead
+    float getPriority(const View& view, glm::ivec3 chunkCoord) const;
+
+    // Wanted chunks for which isKnown (loaded or in flight) is false, most urgent first, at
+    // most maxCount
+    std::vector<glm::ivec3> getMissingChunks(const View& view, const std::function<bool(glm::ivec3)>& isKnown, size_t maxCount) const;
+
+    // The chunks of loaded that are past the unload distance, farthest first, at most maxCount
+    std::vector<glm::ivec3> getExpiredChunks(const View& view, const std::vector<glm::ivec3>& loaded, size_t maxCount) const;
+
+    const Settings& getSettings() const { return settings; }
+
+private:
+    glm::vec3 getPrefetchPosition(const View& view) const { return view.position + view.velocity * settings.prefetchSeconds; }
+
+    // In chunks, to the nearer of the camera and its prefetch position
+    float getDistance(const View& view, glm::ivec3 chunkCoord) const;
+
+    Settings settings{};
+};
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef __CLIMATE_MAP_HPP__
+#define __CLIMATE_MAP_HPP__
+
+#include <chunk.hpp>
+#include <noise.hpp>
+
+#define GLM_FORCE_CXX17
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace engine {
+
+enum Biome : uint8_t {
+    BIOME_OCEAN = 0,
+    BIOME_PLAINS = 1,
+    BIOME_HILLS = 2,
+    BIOME_MOUNTAINS = 3,
+    NUMBER_OF_BIOMES
+};
+
+// What the terrain stages take from the biome; blended between biomes, never switched
+struct BiomeParameters {
+    float hillAmplitude = 0.f;  // blocks of rolling hill noise
+    float ridgeAmplitude = 0.f; // blocks of ridged mountain noise
+    float treeChance = 0.f;     // share of tree attempts that grow
+};
+
+// The climate of one block column
+struct ClimateSample {
+    float continentalness = 0.f; // below about -0.1 is sea, higher is further inland
+    float temperature = 0.f;
+    float humidity = 0.f;
+    Biome biome = BIOME_OCEAN;
+    BiomeParameters parameters{};
+};
+
+// The low-frequency 2D climate fields and the biome layer derived from them. Climate noise
+// is only sampled every CELL_LENGTH blocks, once per REGION_LENGTH^2 region, and the regions
+// are kept in an LRU cache: every chunk of a column and its neighbors read the same region
+// instead of evaluating the noise again. Biome parameters are weighted by how strongly each
+// biome applies at a sample point and bilinearly interpolated in between, so biome borders
+// blend over a cell or more instead of stepping. Thread-safe; results do not depend on what
+// is cached.
+class ClimateMap {
+public:
+    static constexpr int REGION_LENGTH = 256;
+    static constexpr int CELL_LENGTH = 16; // between climate samples
+    static constexpr size_t DEFAULT_CAPACITY = 64; // regions; 2048 x 2048 blocks
+
+    static_assert(REGION_LENGTH % static_cast<int>(CHUNK_LENGTH) == 0, "a chunk column must lie in one region");
+
+    ClimateMap(uint64_t seed, NoiseBackend backend = Noise::getBestBackend(), size_t capacity = DEFAULT_CAPACITY);
+
+    ClimateMap(const ClimateMap&) = delete;
+    ClimateMap& operator=(const ClimateMap&) = delete;
+
+    // The CHUNK_LENGTH^2 columns of a chunk at world block (origin.x + x, origin.y + z), into
+    // out[x + z * CHUNK_LENGTH]; origin must be a multiple of CHUNK_LENGTH
+    void getColumns(glm::ivec2 origin, ClimateSample* out) const;
+
+    ClimateSample getColumn(int x, int z) const;
+
+    size_t getCachedRegionCount() const;
+    uint64_t getRegionBuildCount() const { return regionBuilds.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int POINTS = REGION_LENGTH / CELL_LENGTH + 1; // per axis, both borders included
+
+    struct Point {
+        float continentalness;
+        float temperature;
+        float humidity;
+        BiomeParameters parameters;
+    };
+
+    struct Region {
+        glm::ivec2 coord{};
+        std::vector<Point> points; // [x + z * POINTS]
+    };
+
+    std::shared_ptr<const Region> getRegion(glm::ivec2 regionCoord) const;
+    std::shared_ptr<const Region> buildRegion(glm::ivec2 regionCoord) const;
+    static ClimateSample interpolate(const Region& region, int localX, int localZ);
+
+    Noise continentNoise;
+    Noise temperatureNoise;
+    Noise humidityNoise;
+    const size_t capacity;
+
+    // Regions in use stay alive through their shared_ptr even if evicted meanwhile
+    mutable std::mutex cacheMutex;
+    mutable std::list<std::shared_ptr<const Region>> recentRegions; // most recently used first
+    mutable std::unordered_map<glm::ivec2, std::list<std::shared_ptr<const Region>>::iterator> cachedRegions;
+    mutable std::atomic<uint64_t> regionBuilds{0};
+};
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef __DECORATION_QUEUE_HPP__
+#define __DECORATION_QUEUE_HPP__
+
+#include <chunk.hpp>
+
+#define GLM_FORCE_CXX17
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace engine {
+
+// One block a decoration (tree, structure) of some chunk places in another chunk
+struct DecorationWrite {
+    uint16_t index = 0; // x + (y + z * Chunk::LENGTH) * Chunk::LENGTH in the target chunk
+    BlockType type = AIR;
+};
+
+// Block writes that decorations make outside the chunk they were generated in, held per
+// target chunk until that chunk is finalized. A chunk's generation never touches another
+// chunk, so chunks still generate independently of each other; a chunk is final once its
+// neighbors have generated and their writes into it were applied. Writes for chunks that are
+// not loaded when the world is closed are saved with it (encode, decode).
+//
+// Decoration blocks only replace blocks of a lower rank (air, then leaves, then logs; terrain
+// is never replaced). Taking the highest rank is commutative, so the finished chunk does not
+// depend on the order the writes arrived or were applied in. Thread-safe.
+class DecorationQueue {
+public:
+    void push(glm::ivec3 targetChunk, const std::vector<DecorationWrite>& writes);
+
+    // Applies and removes the writes waiting for the chunk. Returns whether a block changed.
+    bool apply(glm::ivec3 chunkCoord, Chunk& chunk);
+
+    size_t getPendingChunkCount() const;
+
+    // All pending writes, versioned and little-endian, replacing out
+    void encode(std::vector<uint8_t>& out) const;
+    // Queues the writes of an encode; throws std::runtime_error on corrupt data, queuing nothing
+    void decode(const uint8_t* data, size_t size);
+
+    // Whether decoration may be placed over existing
+    static bool overrides(BlockType decoration, BlockType existing) { return getRank(decoration) > getRank(existing); }
+
+private:
+    static constexpr size_t SHARD_COUNT = 16;
+    static constexpr uint8_t VERSION = 1;
+
+    static int getRank(BlockType type) {
+        switch (type) {
+            case AIR:    return 0;
+            case LEAVES: return 1;
+            case LOG:    return 2;
+            default:     return 3;
+        }
+    }
+
+    // Coordinates are spread over shards so generator threads rarely wait for each other
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<glm::ivec3, std::vector<DecorationWrite>> writes;
+    };
+
+    Shard& getShard(glm::ivec3 chunkCoord) { return shards[std::hash<glm::ivec3>{}(chunkCoord) % SHARD_COUNT]; }
+
+    std::array<Shard, SHARD_COUNT> shards;
+};
+
+} // namespace engine
+
+#endif
@@ -85,6 +85,27 @@ private:
     friend class DescriptorWriter;
 };
 
+// Pools of one shape, built from poolBuilder as the earlier ones fill up, for sets whose number
+// is not known up front. Sets are freed to the pool they came from, which therefore needs
+// VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT.
+class DescriptorPoolManager {
+public:
+    explicit DescriptorPoolManager(const DescriptorPool::Builder& poolBuilder) : poolBuilder{poolBuilder} {}
+
+    DescriptorPoolManager(const DescriptorPoolManager&) = delete;
+    DescriptorPoolManager& operator=(const DescriptorPoolManager&) = delete;
+
+    // Allocates from the first pool with room, building a new one when all are full. Returns
+    // the pool the set came from.
+    DescriptorPool& allocateDescriptor(const VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet& descriptor);
+
+    size_t getPoolCount() const { return pools.size(); }
+
+private:
+    const DescriptorPool::Builder poolBuilder;
+    std::vector<std::unique_ptr<DescriptorPool>> pools{};
+};
+
 class DescriptorWriter {
 public:
     DescriptorWriter(DescriptorSetLayout& setLayout, DescriptorPool& pool);
@@ -0,0 +1,115 @@
+#ifndef __FACE_MESH_HPP__
+#define __FACE_MESH_HPP__
+
+#include <device.hpp>
+#include <buffer.hpp>
+#include <descriptors.hpp>
+#include <chunk.hpp>
+#include <upload_queue.hpp>
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace engine {
+
+// One visible (possibly greedy-merged) block face, expanded into two triangles by face.vert.
+//   position  bits  0-14  chunk-local x, y, z of the first block, 5 bits each
+//             bits 15-17  Face
+//             bits 18-22  size along u minus one
+//             bits 23-27  size along v minus one
+//   material  bits  0-7   BlockType
+//             bits  8-15  ambient occlusion level (0-3) of each of the 4 corners, 2 bits each
+// (u, v) are the in-plane axes of the face, as for the chunk column masks.
+struct VoxelFace {
+    static constexpr uint32_t COORD_BITS = 5;
+    static constexpr uint32_t COORD_MASK = (1u << COORD_BITS) - 1;
+    static constexpr uint32_t FACE_SHIFT = 3 * COORD_BITS;
+    static constexpr uint32_t SIZE_U_SHIFT = FACE_SHIFT + 3;
+    static constexpr uint32_t SIZE_V_SHIFT = SIZE_U_SHIFT + COORD_BITS;
+    static constexpr uint32_t AO_SHIFT = 8;
+
+    uint32_t position = 0;
+    uint32_t material = 0;
+
+    static VoxelFace pack(int x, int y, int z, Face face, int sizeU, int sizeV, BlockType type, uint32_t cornerAO = 0) {
+        assert(Chunk::inBounds(x, y, z) && "VoxelFace position out of range");
+        assert(sizeU >= 1 && sizeU <= static_cast<int>(CHUNK_LENGTH) && sizeV >= 1 && sizeV <= static_cast<int>(CHUNK_LENGTH)
+            && "VoxelFace size out of range");
+        VoxelFace record{};
+        record.position = static_cast<uint32_t>(x)
+            | (static_cast<uint32_t>(y) << COORD_BITS)
+            | (static_cast<uint32_t>(z) << (2 * COORD_BITS))
+            | (static_cast<uint32_t>(face) << FACE_SHIFT)
+            | (static_cast<uint32_t>(sizeU - 1) << SIZE_U_SHIFT)
+            | (static_cast<uint32_t>(sizeV - 1) << SIZE_V_SHIFT);
+        record.material = static_cast<uint32_t>(type) | ((cornerAO & 0xff) << AO_SHIFT);
+        return record;
+    }
+
+    int getX() const { return static_cast<int>(position & COORD_MASK); }
+    int getY() const { return static_cast<int>((position >> COORD_BITS) & COORD_MASK); }
+    int getZ() const { return static_cast<int>((position >> (2 * COORD_BITS)) & COORD_MASK); }
+    Face getFace() const { return static_cast<Face>((position >> FACE_SHIFT) & 0x7); }
+    int getSizeU() const { return static_cast<int>((position >> SIZE_U_SHIFT) & COORD_MASK) + 1; }
+    int getSizeV() const { return static_cast<int>((position >> SIZE_V_SHIFT) & COORD_MASK) + 1; }
+    BlockType getBlockType() const { return static_cast<BlockType>(material & 0xff); }
+    uint32_t getAmbientOcclusion(int corner) const { return (material >> (AO_SHIFT + 2 * corner)) & 0x3; }
+
+    bool operator==(const VoxelFace& other) const { return position == other.position && material == other.material; }
+};
+
+static_assert(sizeof(VoxelFace) == 2 * sizeof(uint32_t), "VoxelFace must match the uvec2 records of face.vert");
+
+// Face records of a chunk in a storage buffer. There is no vertex or index buffer: draw
+// issues 6 vertices per face and the vertex shader pulls its record by gl_VertexIndex / 6.
+// Each mesh owns a descriptor set (binding 0: the storage buffer) from one of the given pools,
+// freed to it on destruction. Translucent faces
+// follow the opaque ones in the same buffer and are drawn as a separate range. The records are
+// copied in by the upload queue's next batch.
+class FaceMesh {
+public:
+    static constexpr uint32_t DESCRIPTOR_SET = 1; // set 0 is the global UBO
+
+    struct Builder {
+        std::vector<VoxelFace> faces{};
+        std::vector<VoxelFace> translucentFaces{}; // back to front once sorted
+    };
+
+    FaceMesh(Device& deviceRef, const FaceMesh::Builder& builder, DescriptorSetLayout& setLayout, DescriptorPoolManager& pools,
+        UploadQueue& uploads);
+    ~FaceMesh();
+
+    FaceMesh(const FaceMesh&) = delete;
+    FaceMesh& operator=(const FaceMesh&) = delete;
+
+    void bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout);
+    void draw(VkCommandBuffer commandBuffer);
+    void drawTranslucent(VkCommandBuffer commandBuffer);
+
+    // Rewrites the translucent range with the same faces in a new order (a re-sort), through
+    // the upload queue's next batch
+    void updateTranslucentFaces(const std::vector<VoxelFace>& translucentFaces, UploadQueue& uploads);
+
+    bool hasTranslucent() const { return translucentFaceCount > 0; }
+    uint32_t getFaceCount() const { return faceCount; }
+    uint32_t getTriangleCount() const { return faceCount * 2; }
+    uint32_t getTranslucentTriangleCount() const { return translucentFaceCount * 2; }
+    VkDeviceSize getMemoryUsage() const { return faceBuffer->getBufferSize(); }
+private:
+    void createFaceBuffer(const std::vector<VoxelFace>& faces, const std::vector<VoxelFace>& translucentFaces, UploadQueue& uploads);
+
+    Device& device;
+    DescriptorPool* pool = nullptr; // the one descriptorSet came from
+
+    std::unique_ptr<Buffer> faceBuffer;
+    uint32_t faceCount;
+    uint32_t translucentFaceCount;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+};
+
+} // namespace engine
+
+#endif
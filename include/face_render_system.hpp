@@ -0,0 +1,48 @@
+#ifndef __FACE_RENDER_SYSTEM_HPP__
+#define __FACE_RENDER_SYSTEM_HPP__
+
+#include <device.hpp>
+#include <pipeline.hpp>
+#include <frame_info.hpp>
+#include <render_system.hpp>
+
+#include <vulkan/vulkan.h>
+
+#include <memory>
+
+namespace engine {
+
+// Draws the FaceMesh of every game object by vertex pulling: the pipeline has no vertex
+// input and face.vert reads the face records from the mesh's storage buffer. As with
+// VoxelRenderSystem, only transform.translation and transform.scale.x are applied.
+class FaceRenderSystem {
+public:
+    FaceRenderSystem(Device& deviceRef, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout faceSetLayout);
+    ~FaceRenderSystem();
+
+    FaceRenderSystem(const FaceRenderSystem&) = delete;
+    FaceRenderSystem& operator=(const FaceRenderSystem&) = delete;
+
+    // Opaque quads in any order. The translucent ranges go after all opaque geometry, chunk
+    // by chunk from the farthest, blended and without depth writes. Stats cover both passes.
+    void render(FrameInfo& frameInfo);
+    void renderTranslucent(FrameInfo& frameInfo);
+
+    const RenderStats& getStats() const { return stats; }
+
+private:
+    void createPipelineLayout(VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout faceSetLayout);
+    void createPipeline(VkRenderPass renderPass);
+
+    Device& device;
+
+    std::unique_ptr<Pipeline> pipeline;
+    std::unique_ptr<Pipeline> translucentPipeline;
+    VkPipelineLayout pipelineLayout;
+
+    RenderStats stats{};
+};
+
+} // namespace engine
+
+#endif
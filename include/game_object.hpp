@@ -2,6 +2,8 @@
 #define __GAME_OBJECT_HPP__
 
 #include <model.hpp>
+#include <voxel_mesh.hpp>
+#include <face_mesh.hpp>
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -51,6 +53,8 @@ public:
 
     // Optional pointer components
     std::shared_ptr<Model> model{};
+    std::shared_ptr<VoxelMesh> voxelMesh{}; // chunk terrain, drawn by VoxelRenderSystem
+    std::shared_ptr<FaceMesh> faceMesh{};   // chunk terrain, drawn by FaceRenderSystem
     std::unique_ptr<PointLightComponent> pointLight = nullptr;
 
 private:
@@ -15,6 +15,8 @@ public:
         int moveBackward = GLFW_KEY_S;
         int moveUp = GLFW_KEY_SPACE;
         int moveDown = GLFW_KEY_LEFT_SHIFT;
+        int placeBlock = GLFW_KEY_E;
+        int breakBlock = GLFW_KEY_Q;
     };
 
     void moveInPlaneXZ(GLFWwindow* glfwWindow, float dt, GameObject& gameObject, float cursor_dx, float cursor_dy);
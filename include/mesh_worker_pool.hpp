@@ -0,0 +1,157 @@
+#ifndef __MESH_WORKER_POOL_HPP__
+#define __MESH_WORKER_POOL_HPP__
+
+#include <chunk.hpp>
+#include <chunk_lod.hpp>
+#include <chunk_mesher.hpp>
+#include <mpmc_queue.hpp>
+
+#define GLM_FORCE_CXX17
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine {
+
+// Section meshes produced off the main thread. Only the sections in the submitted mask are
+// rebuilt; the other entries of mesh are empty and must not replace what the caller holds.
+// Results of one chunk can arrive out of order when several jobs are in flight, so a section
+// should only be taken from a result with a higher version than the one it came from.
+// Results of submitWhole have all sections set and the whole chunk in one piece in section 0
+// of mesh, the other entries empty. Results of submitLod carry the whole mesh of that level in
+// lodFaces or lodVertices instead.
+struct MeshResult {
+    glm::ivec3 chunkCoord{};
+    uint64_t sections = 0;
+    uint64_t version = 0; // submission order, starting at 1
+    bool whole = false;   // from submitWhole
+    ChunkMeshSections mesh{};
+    int lodLevel = 0;
+    FaceMesh::Builder lodFaces{};
+    VoxelMesh::Builder lodVertices{};
+};
+
+// A whole chunk mesh (ChunkMeshSections::assemble) whose translucent quads are to be put back
+// to front for viewPosition, in chunk-local block units. Only the builder of the pool's mesh
+// format is used. The same struct comes back from tryPopSorted once sorted.
+struct SortJob {
+    glm::ivec3 chunkCoord{};
+    uint64_t version = 0; // chosen by the caller, to recognize sorts that were superseded
+    int lodLevel = 0;     // of the mesh, for the caller; sorting does not look at it
+    glm::vec3 viewPosition{};
+    FaceMesh::Builder faces{};
+    VoxelMesh::Builder vertices{};
+};
+
+// Worker threads that mesh chunk snapshots. submit() copies the chunk and its gathered
+// neighborhood on the calling thread, so the world can be edited right after; workers
+// mesh the copy and hand results back through a lock-free queue for the main thread to
+// upload (GPU buffers are only ever created on the main thread). The same workers re-sort the
+// translucent quads of finished meshes, ahead of any meshing. submit() and submitSort() are
+// meant to be called from a single thread.
+class MeshWorkerPool {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+
+    // faceRecords selects FaceMesh (vertex pulling) or VoxelMesh output
+    explicit MeshWorkerPool(bool faceRecords, unsigned workerCount = getDefaultWorkerCount());
+    ~MeshWorkerPool();
+
+    MeshWorkerPool(const MeshWorkerPool&) = delete;
+    MeshWorkerPool& operator=(const MeshWorkerPool&) = delete;
+
+    // Queues a remesh of the given sections (Chunk::getSectionIndex bits) of neighborhood.chunk,
+    // taking the border layers already gathered by the caller. Returns the job's version, or 0
+    // (copying nothing) when the job queue is full; retry on a later frame. Without a mode the
+    // pool's default mode is used.
+    uint64_t submit(glm::ivec3 chunkCoord, const ChunkNeighborhood& neighborhood, uint64_t sections, MeshingMode mode);
+    uint64_t submit(glm::ivec3 chunkCoord, const ChunkNeighborhood& neighborhood, uint64_t sections = Chunk::ALL_SECTIONS) {
+        return submit(chunkCoord, neighborhood, sections, defaultMode);
+    }
+
+    // Queues a mesh of the whole chunk in one piece (ChunkMesher::buildMesh). Greedy quads then
+    // run across the section bounds, which saves a few percent of the quads, but an edit can no
+    // longer rebuild just its sections until all of them have been meshed by submit().
+    uint64_t submitWhole(glm::ivec3 chunkCoord, const ChunkNeighborhood& neighborhood, MeshingMode mode);
+    uint64_t submitWhole(glm::ivec3 chunkCoord, const ChunkNeighborhood& neighborhood) {
+        return submitWhole(chunkCoord, neighborhood, defaultMode);
+    }
+
+    // Queues a mesh of one level (1 to ChunkLod::LEVELS - 1) of the chunk's mip chain. Returns
+    // the job's version, or 0 (copying nothing) when the job queue is full.
+    uint64_t submitLod(glm::ivec3 chunkCoord, const ChunkLod& lod, const LodNeighborhood::Neighbors& neighbors, int level,
+        MeshingMode mode);
+    uint64_t submitLod(glm::ivec3 chunkCoord, const ChunkLod& lod, const LodNeighborhood::Neighbors& neighbors, int level) {
+        return submitLod(chunkCoord, lod, neighbors, level, defaultMode);
+    }
+
+    // For the jobs submitted from now on without a mode
+    void setDefaultMode(MeshingMode mode) { defaultMode = mode; }
+    MeshingMode getDefaultMode() const { return defaultMode; }
+
+    // Non-blocking; returns false when no finished mesh is waiting
+    bool tryPopResult(MeshResult& out);
+
+    // Queues a translucent sort (ChunkMesher::sortTranslucentFaces). Moves from job only when
+    // it returns true; false means the sort queue is full.
+    bool submitSort(SortJob&& job);
+    bool tryPopSorted(SortJob& out);
+
+    // Jobs submitted whose result has not been popped yet
+    size_t getPendingCount() const { return pendingCount.load(std::memory_order_relaxed); }
+    size_t getPendingSortCount() const { return pendingSortCount.load(std::memory_order_relaxed); }
+    unsigned getWorkerCount() const { return static_cast<unsigned>(workers.size()); }
+
+    // All hardware threads but the one driving the renderer
+    static unsigned getDefaultWorkerCount();
+
+private:
+    struct Job {
+        glm::ivec3 chunkCoord{};
+        uint64_t sections = 0;
+        uint64_t version = 0;
+        MeshingMode mode = ChunkMesher::DEFAULT_MODE;
+        bool whole = false;
+        Chunk chunk{};
+        ChunkNeighborhood neighborhood{}; // points at chunk above
+        LodNeighborhood lodNeighborhood{}; // only used by LOD jobs
+    };
+
+    uint64_t submitChunk(glm::ivec3 chunkCoord, const ChunkNeighborhood& neighborhood, uint64_t sections, MeshingMode mode, bool whole);
+    void workerLoop();
+    void wakeWorker();
+    bool pushJob(std::unique_ptr<Job> job);
+    void meshChunk(std::unique_ptr<Job> job);
+    void sortMesh(std::unique_ptr<SortJob> job);
+
+    const bool faceRecords;
+
+    MpmcQueue<std::unique_ptr<Job>> jobs{QUEUE_CAPACITY};
+    MpmcQueue<std::unique_ptr<MeshResult>> results{QUEUE_CAPACITY};
+    std::atomic<size_t> pendingCount{0};
+    MpmcQueue<std::unique_ptr<SortJob>> sortJobs{QUEUE_CAPACITY};
+    MpmcQueue<std::unique_ptr<SortJob>> sortResults{QUEUE_CAPACITY};
+    std::atomic<size_t> pendingSortCount{0};
+    uint64_t nextVersion = 1; // only touched by the submitting thread, like defaultMode
+    MeshingMode defaultMode = ChunkMesher::DEFAULT_MODE;
+
+    // Only used to park idle workers; the queues themselves are lock-free
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<size_t> queuedJobs{0}; // mesh and sort jobs together
+    std::atomic<bool> stopping{false};
+
+    std::vector<std::thread> workers;
+};
+
+} // namespace engine
+
+#endif
@@ -47,6 +47,10 @@ public:
 
     void bind(VkCommandBuffer commandBuffer);
     void draw(VkCommandBuffer commandBuffer);
+
+    uint32_t getVertexCount() const { return vertexCount; }
+    uint32_t getIndexCount() const { return hasIndexBuffer ? indexCount : 0; }
+    uint32_t getTriangleCount() const { return (hasIndexBuffer ? indexCount : vertexCount) / 3; }
 private:
     void createVertexBuffers(const std::vector<Vertex> &vertices);
     void createIndexBuffers(const std::vector<uint32_t>& indices);
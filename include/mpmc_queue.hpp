@@ -0,0 +1,91 @@
+#ifndef __MPMC_QUEUE_HPP__
+#define __MPMC_QUEUE_HPP__
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace engine {
+
+// Bounded lock-free multi-producer multi-consumer queue (Dmitry Vyukov's design). Every cell
+// carries a sequence number that tells producers and consumers whether it is free for the
+// current lap, so a push or pop is one CAS on the shared position plus a release store.
+// Neither call blocks: tryPush fails when the queue is full, tryPop when it is empty.
+template <typename T>
+class MpmcQueue {
+public:
+    // capacity must be a power of two
+    explicit MpmcQueue(size_t capacity) : cells{new Cell[capacity]}, mask{capacity - 1} {
+        assert(capacity >= 2 && (capacity & (capacity - 1)) == 0 && "MpmcQueue capacity must be a power of two");
+        for (size_t i = 0; i < capacity; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    // Moves from value only when it returns true
+    bool tryPush(T&& value) {
+        Cell* cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& out) {
+        Cell* cell;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // empty
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->value);
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t getCapacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::unique_ptr<Cell[]> cells;
+    const size_t mask;
+
+    // Producers and consumers each hammer their own position; keep them on separate lines
+    alignas(CACHE_LINE) std::atomic<size_t> enqueuePos{0};
+    alignas(CACHE_LINE) std::atomic<size_t> dequeuePos{0};
+};
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef __NOISE_HPP__
+#define __NOISE_HPP__
+
+#include <chunk.hpp>
+
+#define GLM_FORCE_CXX17
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace engine {
+
+enum NoiseType : uint8_t {
+    NOISE_PERLIN = 0,  // gradient noise on the square/cube lattice
+    NOISE_SIMPLEX = 1  // gradient noise on the simplex lattice: fewer corners, no axis-aligned artifacts
+};
+
+enum NoiseFractal : uint8_t {
+    FRACTAL_FBM = 0,    // sum of octaves, in about [-1, 1]
+    FRACTAL_RIDGED = 1  // sum of (1 - |octave|)^2, in [0, 1] with sharp crests where the octaves cross zero
+};
+
+// Instruction sets the batch functions can run on; all of them give bit-identical results
+enum NoiseBackend : uint8_t {
+    NOISE_BACKEND_SCALAR = 0,
+    NOISE_BACKEND_SSE41 = 1,  // 4 lanes
+    NOISE_BACKEND_AVX2 = 2    // 8 lanes
+};
+
+struct NoiseSettings {
+    static constexpr int MAX_OCTAVES = 8;
+
+    NoiseType type = NOISE_SIMPLEX;
+    NoiseFractal fractal = FRACTAL_FBM;
+    int octaves = 1;              // 1 to MAX_OCTAVES; one FRACTAL_FBM octave is the plain noise
+    float frequency = 1.f / 64.f; // of the first octave, in cycles per block
+    float lacunarity = 2.f;       // frequency ratio between octaves
+    float gain = 0.5f;            // amplitude ratio between octaves
+};
+
+// Seeded 2D and 3D gradient noise for terrain generation. The batch functions evaluate many
+// points per instruction on the widest backend the CPU has; every backend performs the same
+// float operations in the same order (no FMA contraction, see CMakeLists.txt), so a seed
+// gives the same terrain on every machine, whichever backend runs. Coordinates are in blocks
+// and scaled by the settings' frequencies; they should stay below 2^24 / frequency so the
+// lattice cells are exact in float. Thread-safe: all members are const.
+class Noise {
+public:
+    explicit Noise(uint32_t seed, NoiseBackend backend = getBestBackend());
+
+    // One point, on the scalar path
+    float sample(const NoiseSettings& settings, float x, float y) const;
+    float sample(const NoiseSettings& settings, float x, float y, float z) const;
+
+    // count points from coordinate arrays
+    void fill(const NoiseSettings& settings, const float* x, const float* y, float* out, size_t count) const;
+    void fill(const NoiseSettings& settings, const float* x, const float* y, const float* z, float* out, size_t count) const;
+
+    // The CHUNK_LENGTH^2 columns of a chunk at world block (origin.x + x, origin.y + z),
+    // into out[x + z * CHUNK_LENGTH]
+    void fillPlane(const NoiseSettings& settings, glm::ivec2 origin, float* out) const;
+
+    // The CHUNK_LENGTH^3 blocks of a chunk at world block origin + (x, y, z), x fastest, into
+    // out[x + (y + z * CHUNK_LENGTH) * CHUNK_LENGTH]
+    void fillGrid(const NoiseSettings& settings, glm::ivec3 origin, float* out) const;
+
+    // fillGrid for smooth fields such as cave density: the noise is only evaluated every step
+    // blocks, on a lattice of (CHUNK_LENGTH / step + 1)^3 points, and trilinearly interpolated
+    // in between (step 4: 729 evaluations instead of 32768). step is a power of two up to
+    // CHUNK_LENGTH. Chunks share their border lattice points, so the field stays continuous
+    // across chunks. Detail finer than a few steps is lost; sample that at full rate instead.
+    void fillGridCoarse(const NoiseSettings& settings, glm::ivec3 origin, int step, float* out) const;
+
+    uint32_t getSeed() const { return seed; }
+    NoiseBackend getBackend() const { return backend; }
+
+    static bool isBackendSupported(NoiseBackend backend);
+    static NoiseBackend getBestBackend();
+
+private:
+    uint32_t seed;
+    NoiseBackend backend;
+};
+
+} // namespace engine
+
+#endif
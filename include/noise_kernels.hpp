@@ -0,0 +1,384 @@
+#ifndef __NOISE_KERNELS_HPP__
+#define __NOISE_KERNELS_HPP__
+
+// Internal to the Noise backends (noise.cpp, noise_sse41.cpp, noise_avx2.cpp). Each backend
+// instantiates NoiseKernel with its own lane type; being written once is what keeps them
+// bit-identical. The templates live in an anonymous namespace because the backends are
+// compiled with different instruction sets: shared inline code could otherwise be merged by
+// the linker and run AVX2 instructions on the scalar path.
+
+#include <noise.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine {
+
+// NoiseSettings expanded per octave, once, in scalar code, so every backend multiplies by
+// the very same floats
+struct FractalParams {
+    NoiseType type = NOISE_SIMPLEX;
+    NoiseFractal fractal = FRACTAL_FBM;
+    int octaves = 1;
+    std::array<float, NoiseSettings::MAX_OCTAVES> frequencies{};
+    std::array<float, NoiseSettings::MAX_OCTAVES> amplitudes{};
+    std::array<uint32_t, NoiseSettings::MAX_OCTAVES> seeds{};
+    float scale = 1.f; // 1 / sum of the amplitudes
+};
+
+void fillNoiseScalar(const FractalParams& params, const float* x, const float* y, float* out, size_t count);
+void fillNoiseScalar(const FractalParams& params, const float* x, const float* y, const float* z, float* out, size_t count);
+void fillNoiseSse41(const FractalParams& params, const float* x, const float* y, float* out, size_t count);
+void fillNoiseSse41(const FractalParams& params, const float* x, const float* y, const float* z, float* out, size_t count);
+void fillNoiseAvx2(const FractalParams& params, const float* x, const float* y, float* out, size_t count);
+void fillNoiseAvx2(const FractalParams& params, const float* x, const float* y, const float* z, float* out, size_t count);
+void upsampleGridScalar(const float* lattice, int step, float* out);
+void upsampleGridSse41(const float* lattice, int step, float* out);
+void upsampleGridAvx2(const float* lattice, int step, float* out);
+
+namespace {
+
+// Lanes provides, for WIDTH lanes at once: float vectors F, 32-bit unsigned integer vectors I
+// and lane masks M, with
+//   splat, load, store, add, sub, mul, floor, abs, neg, select(M, F if set, F otherwise),
+//   lessThan (F, F -> M), notMask, andMask, orMask,
+//   splatInt, toInt (truncating), addInt, mulInt, xorInt, shiftRight (logical),
+//   testBits(I h, mask, value) -> M set where (h & mask) == value
+// all with IEEE single precision semantics and wrapping integer arithmetic.
+template <typename Lanes>
+struct NoiseKernel {
+    using F = typename Lanes::F;
+    using I = typename Lanes::I;
+    using M = typename Lanes::M;
+
+    static F fade(F t) {
+        // t^3 (t (6t - 15) + 10)
+        const F inner = Lanes::add(Lanes::mul(t, Lanes::sub(Lanes::mul(t, Lanes::splat(6.f)), Lanes::splat(15.f))), Lanes::splat(10.f));
+        return Lanes::mul(Lanes::mul(Lanes::mul(t, t), t), inner);
+    }
+
+    static F lerp(F t, F a, F b) { return Lanes::add(a, Lanes::mul(t, Lanes::sub(b, a))); }
+
+    static I hash(uint32_t seed, I x, I y) {
+        I h = Lanes::xorInt(Lanes::xorInt(Lanes::splatInt(seed), Lanes::mulInt(x, Lanes::splatInt(501125321u))),
+            Lanes::mulInt(y, Lanes::splatInt(1136930381u)));
+        h = Lanes::mulInt(h, Lanes::splatInt(0x27d4eb2du));
+        return Lanes::xorInt(h, Lanes::shiftRight(h, 15));
+    }
+
+    static I hash(uint32_t seed, I x, I y, I z) {
+        I h = Lanes::xorInt(Lanes::xorInt(Lanes::splatInt(seed), Lanes::mulInt(x, Lanes::splatInt(501125321u))),
+            Lanes::xorInt(Lanes::mulInt(y, Lanes::splatInt(1136930381u)), Lanes::mulInt(z, Lanes::splatInt(1720413743u))));
+        h = Lanes::mulInt(h, Lanes::splatInt(0x27d4eb2du));
+        return Lanes::xorInt(h, Lanes::shiftRight(h, 15));
+    }
+
+    // Dot product with one of 8 gradients picked by the low 3 bits of h: (+-1, +-2) and (+-2, +-1)
+    static F grad(I h, F x, F y) {
+        const M xFirst = Lanes::testBits(h, 4u, 0u);
+        const F u = Lanes::select(xFirst, x, y);
+        const F v = Lanes::select(xFirst, y, x);
+        const F v2 = Lanes::add(v, v);
+        return Lanes::add(Lanes::select(Lanes::testBits(h, 1u, 1u), Lanes::neg(u), u),
+            Lanes::select(Lanes::testBits(h, 2u, 2u), Lanes::neg(v2), v2));
+    }
+
+    // Dot product with one of the 12 cube edge directions (4 of them twice), by the low 4 bits of h
+    static F grad(I h, F x, F y, F z) {
+        const F u = Lanes::select(Lanes::testBits(h, 8u, 0u), x, y);
+        const F v = Lanes::select(Lanes::testBits(h, 12u, 0u), y, Lanes::select(Lanes::testBits(h, 13u, 12u), x, z));
+        return Lanes::add(Lanes::select(Lanes::testBits(h, 1u, 1u), Lanes::neg(u), u),
+            Lanes::select(Lanes::testBits(h, 2u, 2u), Lanes::neg(v), v));
+    }
+
+    static F perlin(uint32_t seed, F x, F y) {
+        const F fx = Lanes::floor(x);
+        const F fy = Lanes::floor(y);
+        const I ix = Lanes::toInt(fx);
+        const I iy = Lanes::toInt(fy);
+        const I ix1 = Lanes::addInt(ix, Lanes::splatInt(1u));
+        const I iy1 = Lanes::addInt(iy, Lanes::splatInt(1u));
+        const F one = Lanes::splat(1.f);
+        const F x0 = Lanes::sub(x, fx);
+        const F y0 = Lanes::sub(y, fy);
+        const F x1 = Lanes::sub(x0, one);
+        const F y1 = Lanes::sub(y0, one);
+
+        const F n00 = grad(hash(seed, ix, iy), x0, y0);
+        const F n01 = grad(hash(seed, ix, iy1), x0, y1);
+        const F n10 = grad(hash(seed, ix1, iy), x1, y0);
+        const F n11 = grad(hash(seed, ix1, iy1), x1, y1);
+
+        const F s = fade(x0);
+        const F t = fade(y0);
+        return Lanes::mul(Lanes::splat(0.507f), lerp(s, lerp(t, n00, n01), lerp(t, n10, n11)));
+    }
+
+    static F perlin(uint32_t seed, F x, F y, F z) {
+        const F fx = Lanes::floor(x);
+        const F fy = Lanes::floor(y);
+        const F fz = Lanes::floor(z);
+        const I ix = Lanes::toInt(fx);
+        const I iy = Lanes::toInt(fy);
+        const I iz = Lanes::toInt(fz);
+        const I ix1 = Lanes::addInt(ix, Lanes::splatInt(1u));
+        const I iy1 = Lanes::addInt(iy, Lanes::splatInt(1u));
+        const I iz1 = Lanes::addInt(iz, Lanes::splatInt(1u));
+        const F one = Lanes::splat(1.f);
+        const F x0 = Lanes::sub(x, fx);
+        const F y0 = Lanes::sub(y, fy);
+        const F z0 = Lanes::sub(z, fz);
+        const F x1 = Lanes::sub(x0, one);
+        const F y1 = Lanes::sub(y0, one);
+        const F z1 = Lanes::sub(z0, one);
+
+        const F n000 = grad(hash(seed, ix, iy, iz), x0, y0, z0);
+        const F n001 = grad(hash(seed, ix, iy, iz1), x0, y0, z1);
+        const F n010 = grad(hash(seed, ix, iy1, iz), x0, y1, z0);
+        const F n011 = grad(hash(seed, ix, iy1, iz1), x0, y1, z1);
+        const F n100 = grad(hash(seed, ix1, iy, iz), x1, y0, z0);
+        const F n101 = grad(hash(seed, ix1, iy, iz1), x1, y0, z1);
+        const F n110 = grad(hash(seed, ix1, iy1, iz), x1, y1, z0);
+        const F n111 = grad(hash(seed, ix1, iy1, iz1), x1, y1, z1);
+
+        const F s = fade(x0);
+        const F t = fade(y0);
+        const F r = fade(z0);
+        const F nx0 = lerp(t, lerp(r, n000, n001), lerp(r, n010, n011));
+        const F nx1 = lerp(t, lerp(r, n100, n101), lerp(r, n110, n111));
+        return Lanes::mul(Lanes::splat(0.936f), lerp(s, nx0, nx1));
+    }
+
+    // (radius - |d|^2)^4 * grad, or 0 outside the radius
+    static F corner(F radius, I h, F x, F y) {
+        F t = Lanes::sub(Lanes::sub(radius, Lanes::mul(x, x)), Lanes::mul(y, y));
+        t = Lanes::select(Lanes::lessThan(t, Lanes::splat(0.f)), Lanes::splat(0.f), t);
+        t = Lanes::mul(t, t);
+        return Lanes::mul(Lanes::mul(t, t), grad(h, x, y));
+    }
+
+    static F corner(F radius, I h, F x, F y, F z) {
+        F t = Lanes::sub(Lanes::sub(Lanes::sub(radius, Lanes::mul(x, x)), Lanes::mul(y, y)), Lanes::mul(z, z));
+        t = Lanes::select(Lanes::lessThan(t, Lanes::splat(0.f)), Lanes::splat(0.f), t);
+        t = Lanes::mul(t, t);
+        return Lanes::mul(Lanes::mul(t, t), grad(h, x, y, z));
+    }
+
+    static F simplex(uint32_t seed, F x, F y) {
+        const F skew = Lanes::splat(0.366025403f);   // (sqrt(3) - 1) / 2
+        const F unskew = Lanes::splat(0.211324865f); // (3 - sqrt(3)) / 6
+        const F zero = Lanes::splat(0.f);
+        const F one = Lanes::splat(1.f);
+
+        const F s = Lanes::mul(Lanes::add(x, y), skew);
+        const F fi = Lanes::floor(Lanes::add(x, s));
+        const F fj = Lanes::floor(Lanes::add(y, s));
+        const F t = Lanes::mul(Lanes::add(fi, fj), unskew);
+        const F x0 = Lanes::sub(x, Lanes::sub(fi, t));
+        const F y0 = Lanes::sub(y, Lanes::sub(fj, t));
+
+        // Lower or upper triangle of the skewed cell
+        const M lower = Lanes::lessThan(y0, x0);
+        const F i1 = Lanes::select(lower, one, zero);
+        const F j1 = Lanes::select(lower, zero, one);
+
+        const F x1 = Lanes::add(Lanes::sub(x0, i1), unskew);
+        const F y1 = Lanes::add(Lanes::sub(y0, j1), unskew);
+        const F twoUnskew = Lanes::add(unskew, unskew);
+        const F x2 = Lanes::add(Lanes::sub(x0, one), twoUnskew);
+        const F y2 = Lanes::add(Lanes::sub(y0, one), twoUnskew);
+
+        const I ii = Lanes::toInt(fi);
+        const I jj = Lanes::toInt(fj);
+        const I h0 = hash(seed, ii, jj);
+        const I h1 = hash(seed, Lanes::toInt(Lanes::add(fi, i1)), Lanes::toInt(Lanes::add(fj, j1)));
+        const I h2 = hash(seed, Lanes::addInt(ii, Lanes::splatInt(1u)), Lanes::addInt(jj, Lanes::splatInt(1u)));
+
+        const F radius = Lanes::splat(0.5f);
+        const F sum = Lanes::add(Lanes::add(corner(radius, h0, x0, y0), corner(radius, h1, x1, y1)), corner(radius, h2, x2, y2));
+        return Lanes::mul(Lanes::splat(40.f), sum);
+    }
+
+    static F simplex(uint32_t seed, F x, F y, F z) {
+        const F skew = Lanes::splat(1.f / 3.f);
+        const F unskew = Lanes::splat(1.f / 6.f);
+        const F zero = Lanes::splat(0.f);
+        const F one = Lanes::splat(1.f);
+
+        const F s = Lanes::mul(Lanes::add(Lanes::add(x, y), z), skew);
+        const F fi = Lanes::floor(Lanes::add(x, s));
+        const F fj = Lanes::floor(Lanes::add(y, s));
+        const F fk = Lanes::floor(Lanes::add(z, s));
+        const F t = Lanes::mul(Lanes::add(Lanes::add(fi, fj), fk), unskew);
+        const F x0 = Lanes::sub(x, Lanes::sub(fi, t));
+        const F y0 = Lanes::sub(y, Lanes::sub(fj, t));
+        const F z0 = Lanes::sub(z, Lanes::sub(fk, t));
+
+        // Which of the 6 tetrahedra of the skewed cube: the second corner steps along the
+        // largest offset, the third along the two largest
+        const M xy = Lanes::notMask(Lanes::lessThan(x0, y0)); // x0 >= y0
+        const M yz = Lanes::notMask(Lanes::lessThan(y0, z0)); // y0 >= z0
+        const M xz = Lanes::notMask(Lanes::lessThan(x0, z0)); // x0 >= z0
+        const F i1 = Lanes::select(Lanes::andMask(xy, xz), one, zero);
+        const F j1 = Lanes::select(Lanes::andMask(Lanes::notMask(xy), yz), one, zero);
+        const F k1 = Lanes::select(Lanes::notMask(Lanes::orMask(yz, xz)), one, zero);
+        const F i2 = Lanes::select(Lanes::orMask(xy, xz), one, zero);
+        const F j2 = Lanes::select(Lanes::orMask(Lanes::notMask(xy), yz), one, zero);
+        const F k2 = Lanes::select(Lanes::notMask(Lanes::andMask(yz, xz)), one, zero);
+
+        const F x1 = Lanes::add(Lanes::sub(x0, i1), unskew);
+        const F y1 = Lanes::add(Lanes::sub(y0, j1), unskew);
+        const F z1 = Lanes::add(Lanes::sub(z0, k1), unskew);
+        const F twoUnskew = Lanes::add(unskew, unskew);
+        const F x2 = Lanes::add(Lanes::sub(x0, i2), twoUnskew);
+        const F y2 = Lanes::add(Lanes::sub(y0, j2), twoUnskew);
+        const F z2 = Lanes::add(Lanes::sub(z0, k2), twoUnskew);
+        const F threeUnskew = Lanes::add(twoUnskew, unskew);
+        const F x3 = Lanes::add(Lanes::sub(x0, one), threeUnskew);
+        const F y3 = Lanes::add(Lanes::sub(y0, one), threeUnskew);
+        const F z3 = Lanes::add(Lanes::sub(z0, one), threeUnskew);
+
+        const I ii = Lanes::toInt(fi);
+        const I jj = Lanes::toInt(fj);
+        const I kk = Lanes::toInt(fk);
+        const I h0 = hash(seed, ii, jj, kk);
+        const I h1 = hash(seed, Lanes::toInt(Lanes::add(fi, i1)), Lanes::toInt(Lanes::add(fj, j1)), Lanes::toInt(Lanes::add(fk, k1)));
+        const I h2 = hash(seed, Lanes::toInt(Lanes::add(fi, i2)), Lanes::toInt(Lanes::add(fj, j2)), Lanes::toInt(Lanes::add(fk, k2)));
+        const I h3 = hash(seed, Lanes::addInt(ii, Lanes::splatInt(1u)), Lanes::addInt(jj, Lanes::splatInt(1u)),
+            Lanes::addInt(kk, Lanes::splatInt(1u)));
+
+        const F radius = Lanes::splat(0.6f);
+        const F sum = Lanes::add(Lanes::add(corner(radius, h0, x0, y0, z0), corner(radius, h1, x1, y1, z1)),
+            Lanes::add(corner(radius, h2, x2, y2, z2), corner(radius, h3, x3, y3, z3)));
+        return Lanes::mul(Lanes::splat(32.f), sum);
+    }
+
+    static F octave(const FractalParams& params, int index, F x, F y) {
+        const F frequency = Lanes::splat(params.frequencies[index]);
+        x = Lanes::mul(x, frequency);
+        y = Lanes::mul(y, frequency);
+        return params.type == NOISE_PERLIN ? perlin(params.seeds[index], x, y) : simplex(params.seeds[index], x, y);
+    }
+
+    static F octave(const FractalParams& params, int index, F x, F y, F z) {
+        const F frequency = Lanes::splat(params.frequencies[index]);
+        x = Lanes::mul(x, frequency);
+        y = Lanes::mul(y, frequency);
+        z = Lanes::mul(z, frequency);
+        return params.type == NOISE_PERLIN ? perlin(params.seeds[index], x, y, z) : simplex(params.seeds[index], x, y, z);
+    }
+
+    template <typename... Coords>
+    static F fractal(const FractalParams& params, Coords... coords) {
+        F sum = Lanes::splat(0.f);
+        for (int index = 0; index < params.octaves; index++) {
+            F n = octave(params, index, coords...);
+            if (params.fractal == FRACTAL_RIDGED) {
+                n = Lanes::sub(Lanes::splat(1.f), Lanes::abs(n));
+                n = Lanes::mul(n, n);
+            }
+            sum = Lanes::add(sum, Lanes::mul(n, Lanes::splat(params.amplitudes[index])));
+        }
+        return Lanes::mul(sum, Lanes::splat(params.scale));
+    }
+
+    // Full vectors, then the tail through a zero-padded one
+    static void fill(const FractalParams& params, const float* x, const float* y, float* out, size_t count) {
+        size_t i = 0;
+        for (; i + Lanes::WIDTH <= count; i += Lanes::WIDTH) {
+            Lanes::store(out + i, fractal(params, Lanes::load(x + i), Lanes::load(y + i)));
+        }
+        if (i == count) return;
+        float tail[3][Lanes::WIDTH] = {};
+        for (size_t lane = 0; i + lane < count; lane++) {
+            tail[0][lane] = x[i + lane];
+            tail[1][lane] = y[i + lane];
+        }
+        Lanes::store(tail[2], fractal(params, Lanes::load(tail[0]), Lanes::load(tail[1])));
+        for (size_t lane = 0; i + lane < count; lane++) {
+            out[i + lane] = tail[2][lane];
+        }
+    }
+
+    static void fill(const FractalParams& params, const float* x, const float* y, const float* z, float* out, size_t count) {
+        size_t i = 0;
+        for (; i + Lanes::WIDTH <= count; i += Lanes::WIDTH) {
+            Lanes::store(out + i, fractal(params, Lanes::load(x + i), Lanes::load(y + i), Lanes::load(z + i)));
+        }
+        if (i == count) return;
+        float tail[4][Lanes::WIDTH] = {};
+        for (size_t lane = 0; i + lane < count; lane++) {
+            tail[0][lane] = x[i + lane];
+            tail[1][lane] = y[i + lane];
+            tail[2][lane] = z[i + lane];
+        }
+        Lanes::store(tail[3], fractal(params, Lanes::load(tail[0]), Lanes::load(tail[1]), Lanes::load(tail[2])));
+        for (size_t lane = 0; i + lane < count; lane++) {
+            out[i + lane] = tail[3][lane];
+        }
+    }
+
+    // Trilinear interpolation of a lattice of (CHUNK_LENGTH / step + 1)^3 points, one every
+    // step blocks, x fastest, into the CHUNK_LENGTH^3 grid of Noise::fillGrid. Separable: the
+    // lattice rows are widened along x, then lerped along y into full planes, then along z,
+    // every pass a lerp of whole rows (CHUNK_LENGTH is a multiple of every WIDTH). The
+    // fractions are exact for power-of-two steps, so lattice points come through unchanged.
+    static void upsample(const float* lattice, int step, float* out) {
+        constexpr size_t length = CHUNK_LENGTH;
+        const size_t points = length / static_cast<size_t>(step) + 1;
+        const size_t cellSize = static_cast<size_t>(step);
+
+        std::array<float, CHUNK_LENGTH> fractions;
+        for (size_t i = 0; i < length; i++) {
+            fractions[i] = static_cast<float>(i % cellSize) / static_cast<float>(step);
+        }
+
+        std::vector<float> rows(points * points * length); // [x + (j + k * points) * length]
+        std::array<float, CHUNK_LENGTH> low;
+        std::array<float, CHUNK_LENGTH> high;
+        for (size_t line = 0; line < points * points; line++) {
+            const float* in = lattice + line * points;
+            for (size_t x = 0; x < length; x++) {
+                low[x] = in[x / cellSize];
+                high[x] = in[x / cellSize + 1];
+            }
+            for (size_t x = 0; x < length; x += Lanes::WIDTH) {
+                Lanes::store(rows.data() + line * length + x,
+                    lerp(Lanes::load(fractions.data() + x), Lanes::load(low.data() + x), Lanes::load(high.data() + x)));
+            }
+        }
+
+        std::vector<float> planes(points * length * length); // [x + (y + k * length) * length]
+        for (size_t k = 0; k < points; k++) {
+            for (size_t y = 0; y < length; y++) {
+                const F t = Lanes::splat(fractions[y]);
+                const float* a = rows.data() + (y / cellSize + k * points) * length;
+                const float* b = a + length;
+                float* dst = planes.data() + (y + k * length) * length;
+                for (size_t x = 0; x < length; x += Lanes::WIDTH) {
+                    Lanes::store(dst + x, lerp(t, Lanes::load(a + x), Lanes::load(b + x)));
+                }
+            }
+        }
+
+        for (size_t z = 0; z < length; z++) {
+            const F t = Lanes::splat(fractions[z]);
+            for (size_t y = 0; y < length; y++) {
+                const float* a = planes.data() + (y + z / cellSize * length) * length;
+                const float* b = a + length * length;
+                float* dst = out + (y + z * length) * length;
+                for (size_t x = 0; x < length; x += Lanes::WIDTH) {
+                    Lanes::store(dst + x, lerp(t, Lanes::load(a + x), Lanes::load(b + x)));
+                }
+            }
+        }
+    }
+};
+
+} // namespace
+
+} // namespace engine
+
+#endif
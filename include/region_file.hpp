@@ -0,0 +1,121 @@
+#ifndef __REGION_FILE_HPP__
+#define __REGION_FILE_HPP__
+
+#define GLM_FORCE_CXX17
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <async_file_io.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace engine {
+
+// The stored chunks of LENGTH x LENGTH chunk columns, HEIGHT chunks tall, in one file. The
+// file starts with a fixed-size table of (first sector, byte size) per chunk, so a chunk is
+// found with one lookup and no parsing; payloads follow in SECTOR_SIZE sectors. The file is
+// memory-mapped: reading a chunk touches only the table entry and the pages of its payload.
+//
+// A write goes to free sectors first and only then points the table at them, so a process
+// that dies mid-write leaves the previous copy intact. That ordering only holds in memory: the
+// system writes dirty pages back in any order, so after a system crash or power loss the table
+// may point at sectors that never reached the disk, for any write made since the last flush()
+// returned. Sectors given up by rewrites are reused.
+// Payloads are opaque to the file. Thread-safe: reads share a lock, writes are exclusive.
+//
+// The payloads can also be read and written with AsyncFileIo on the file itself, which sees
+// the same pages as the mapping. A read pins the sectors it reads until it ends, and a write
+// goes to reserved sectors that only become the chunk's when it is committed, so neither
+// blocks the table for the duration of the I/O.
+class RegionFile {
+public:
+    static constexpr int LENGTH = 32;       // chunk columns per side
+    static constexpr int HEIGHT = 8;        // chunks per column
+    static constexpr int MIN_CHUNK_Y = -4;  // chunk y of the top of every column
+    static constexpr size_t CHUNK_COUNT = static_cast<size_t>(LENGTH * LENGTH * HEIGHT);
+    static constexpr size_t SECTOR_SIZE = 512; // most encoded chunks take one to three
+
+    // A payload's place in the file. Little-endian on disk, like the hosts we target.
+    struct Extent {
+        uint32_t sector = 0; // first sector of the payload, 0 if none
+        uint32_t size = 0;   // in bytes
+
+        uint64_t getOffset() const { return static_cast<uint64_t>(sector) * SECTOR_SIZE; }
+    };
+
+    // Opens the file, creating an empty region if it does not exist
+    explicit RegionFile(const std::string& path);
+    ~RegionFile(); // flushes
+
+    RegionFile(const RegionFile&) = delete;
+    RegionFile& operator=(const RegionFile&) = delete;
+
+    // The region holding a chunk column, by floor division of its x and z
+    static glm::ivec2 getRegionCoord(glm::ivec3 chunkCoord);
+    // Whether a column has room for the chunk's y
+    static bool isStorable(glm::ivec3 chunkCoord) {
+        return chunkCoord.y >= MIN_CHUNK_Y && chunkCoord.y < MIN_CHUNK_Y + HEIGHT;
+    }
+
+    // Calls consume with the stored payload, which points into the mapping and is only valid
+    // during the call. Returns false, without calling it, if the chunk was never written.
+    bool read(glm::ivec3 chunkCoord, const std::function<void(const uint8_t* data, size_t size)>& consume) const;
+    void write(glm::ivec3 chunkCoord, const uint8_t* data, size_t size);
+
+    // For reading a payload from the file: its sectors are not handed out again, even if the
+    // chunk is rewritten meanwhile, until endRead. Returns false, pinning nothing, if the
+    // chunk was never written.
+    bool beginRead(glm::ivec3 chunkCoord, Extent& extent);
+    void endRead();
+
+    // For writing a payload to the file: reserve sectors for size bytes, write them at the
+    // extent's offset, then commit them as the chunk's payload, or release them if the write
+    // failed or was superseded
+    Extent reserve(size_t size);
+    void commit(glm::ivec3 chunkCoord, Extent extent);
+    void release(Extent extent);
+
+    AsyncFileIo::NativeFile getNativeFile() const { return file; }
+
+    // Writes the mapped pages back to disk; every write made before it is durable once it returns
+    void flush();
+
+    size_t getFileSize() const;
+
+private:
+    static size_t getEntryIndex(glm::ivec3 chunkCoord);
+    static size_t getSectorCount(size_t size) { return (size + SECTOR_SIZE - 1) / SECTOR_SIZE; }
+
+    Extent readEntry(size_t index) const;
+    void writeEntry(size_t index, Extent entry);
+    size_t allocate(size_t sectors);
+    void free(Extent extent); // deferred while reads are pinned
+    void map(size_t size);
+    void unmap();
+
+    std::string path;
+#ifdef _WIN32
+    void* file = nullptr;    // HANDLE
+    void* mapping = nullptr; // HANDLE
+#else
+    int file = -1;
+#endif
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    std::vector<bool> usedSectors; // the header's sectors included
+    std::vector<Extent> deferredFrees;
+    std::atomic<size_t> pinnedReads{0};
+
+    mutable std::shared_mutex mutex;
+};
+
+} // namespace engine
+
+#endif
@@ -11,6 +11,12 @@
 
 namespace engine {
 
+// What the last renderGameObjects call submitted
+struct RenderStats {
+    uint32_t drawCalls = 0;
+    uint32_t triangleCount = 0;
+};
+
 class RenderSystem {
 public:
     RenderSystem(Device& deviceRef, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
@@ -21,6 +27,8 @@ public:
 
     void renderGameObjects(FrameInfo& frameInfo);
 
+    const RenderStats& getStats() const { return stats; }
+
 private:
     void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
     void createPipeline(VkRenderPass renderPass);
@@ -29,6 +37,8 @@ private:
 
     std::unique_ptr<Pipeline> pipeline;
     VkPipelineLayout pipelineLayout;
+
+    RenderStats stats{};
 };
 
 } // namespace engine
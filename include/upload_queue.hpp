@@ -0,0 +1,58 @@
+#ifndef __UPLOAD_QUEUE_HPP__
+#define __UPLOAD_QUEUE_HPP__
+
+#include <device.hpp>
+#include <buffer.hpp>
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace engine {
+
+// Copies into device-local buffers through staging buffers, recorded into one command buffer
+// and submitted as a batch with a fence, instead of a queue submission and a wait per copy.
+// The staging buffers are released once the batch's fence has signaled. Batches go to the
+// graphics queue between barriers: the copies wait for the vertex stages of the frames
+// submitted before, so they may overwrite data those frames still read, and frames submitted
+// after see the new data. A destination buffer must outlive the frames that draw from it
+// anyway, which also covers its copy. Main thread only.
+class UploadQueue {
+public:
+    explicit UploadQueue(Device& deviceRef);
+    ~UploadQueue(); // waits for the batches in flight
+
+    UploadQueue(const UploadQueue&) = delete;
+    UploadQueue& operator=(const UploadQueue&) = delete;
+
+    // Records a copy of size bytes from data to dstOffset in dstBuffer, which needs
+    // VK_BUFFER_USAGE_TRANSFER_DST_BIT. data is staged right away, so it may go afterwards.
+    void upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+    // Submits the copies recorded since the last submit, if there are any
+    void submit();
+
+    // Releases the staging buffers of the batches that have finished, without blocking
+    void collect();
+
+    size_t getBatchesInFlight() const { return inFlight.size(); }
+private:
+    struct Batch {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        std::vector<std::unique_ptr<Buffer>> stagingBuffers{};
+    };
+
+    void release(Batch& batch);
+
+    Device& device;
+    Batch recording{}; // its command buffer is begun by the first upload after a submit
+    std::vector<Batch> inFlight{};
+    std::vector<VkFence> idleFences{};
+};
+
+} // namespace engine
+
+#endif
@@ -1,8 +1,13 @@
 #ifndef __UTILS_HPP__
 #define __UTILS_HPP__
 
+#include <cstdint>
 #include <functional>
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
 namespace engine {
 
 template <typename T, typename... Rest>
@@ -11,6 +16,27 @@ void hashCombine(std::size_t& seed, const T& v, const Rest&... rest) {
     (hashCombine(seed, rest), ...);
 };
 
+// Index of the lowest set bit; value must not be zero
+inline int countTrailingZeros(uint32_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+inline int countTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
 } // namespace engine
 
 #endif
\ No newline at end of file
@@ -0,0 +1,109 @@
+#ifndef __VOXEL_MESH_HPP__
+#define __VOXEL_MESH_HPP__
+
+#include <device.hpp>
+#include <buffer.hpp>
+#include <chunk.hpp>
+#include <upload_queue.hpp>
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace engine {
+
+// Terrain vertex packed into one 32-bit word (Model::Vertex is 44 bytes):
+//   bits  0-17  chunk-local x, y, z, 6 bits each (0..LENGTH: quads end on the far corner)
+//   bits 18-20  Face, which the shader turns into the normal
+//   bits 21-22  ambient occlusion level, 0 (open) to 3 (fully occluded)
+//   bits 23-30  BlockType, which the shader turns into the color
+// The chunk origin comes from a push constant (see VoxelRenderSystem).
+struct VoxelVertex {
+    static constexpr uint32_t COORD_BITS = 6;
+    static constexpr uint32_t COORD_MASK = (1u << COORD_BITS) - 1;
+    static constexpr uint32_t FACE_SHIFT = 3 * COORD_BITS;
+    static constexpr uint32_t AO_SHIFT = FACE_SHIFT + 3;
+    static constexpr uint32_t TYPE_SHIFT = AO_SHIFT + 2;
+
+    uint32_t data = 0;
+
+    static VoxelVertex pack(int x, int y, int z, Face face, BlockType type, uint32_t ao = 0) {
+        assert(x >= 0 && x <= static_cast<int>(CHUNK_LENGTH) && y >= 0 && y <= static_cast<int>(CHUNK_LENGTH)
+            && z >= 0 && z <= static_cast<int>(CHUNK_LENGTH) && "VoxelVertex position out of range");
+        assert(ao <= 3 && "VoxelVertex ambient occlusion level out of range");
+        VoxelVertex vertex{};
+        vertex.data = static_cast<uint32_t>(x)
+            | (static_cast<uint32_t>(y) << COORD_BITS)
+            | (static_cast<uint32_t>(z) << (2 * COORD_BITS))
+            | (static_cast<uint32_t>(face) << FACE_SHIFT)
+            | (ao << AO_SHIFT)
+            | (static_cast<uint32_t>(type) << TYPE_SHIFT);
+        return vertex;
+    }
+
+    int getX() const { return static_cast<int>(data & COORD_MASK); }
+    int getY() const { return static_cast<int>((data >> COORD_BITS) & COORD_MASK); }
+    int getZ() const { return static_cast<int>((data >> (2 * COORD_BITS)) & COORD_MASK); }
+    Face getFace() const { return static_cast<Face>((data >> FACE_SHIFT) & 0x7); }
+    uint32_t getAmbientOcclusion() const { return (data >> AO_SHIFT) & 0x3; }
+    BlockType getBlockType() const { return static_cast<BlockType>((data >> TYPE_SHIFT) & 0xff); }
+
+    static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
+    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+
+    bool operator==(const VoxelVertex& other) const { return data == other.data; }
+};
+
+static_assert(sizeof(VoxelVertex) == sizeof(uint32_t), "VoxelVertex must stay a single packed word");
+
+// GPU vertex and index buffers of a chunk mesh, the VoxelVertex counterpart of Model.
+// Translucent quads share the vertex buffer but have their own index range after the opaque
+// one, so they can be drawn (and reordered) separately. The buffers are filled by the upload
+// queue's next batch.
+class VoxelMesh {
+public:
+    struct Builder {
+        std::vector<VoxelVertex> vertices{};
+        std::vector<uint32_t> indices{};
+        std::vector<uint32_t> translucentIndices{}; // back to front once sorted
+    };
+
+    VoxelMesh(Device& deviceRef, const VoxelMesh::Builder& builder, UploadQueue& uploads);
+    ~VoxelMesh();
+
+    VoxelMesh(const VoxelMesh&) = delete;
+    VoxelMesh& operator=(const VoxelMesh&) = delete;
+
+    void bind(VkCommandBuffer commandBuffer);
+    void draw(VkCommandBuffer commandBuffer);
+    void drawTranslucent(VkCommandBuffer commandBuffer);
+
+    // Rewrites the translucent index range with the same quads in a new order (a re-sort),
+    // through the upload queue's next batch
+    void updateTranslucentIndices(const std::vector<uint32_t>& translucentIndices, UploadQueue& uploads);
+
+    bool hasTranslucent() const { return translucentIndexCount > 0; }
+    uint32_t getVertexCount() const { return vertexCount; }
+    uint32_t getIndexCount() const { return indexCount; }
+    uint32_t getTriangleCount() const { return indexCount / 3; }
+    uint32_t getTranslucentTriangleCount() const { return translucentIndexCount / 3; }
+    VkDeviceSize getMemoryUsage() const; // bytes of vertex and index buffer
+private:
+    void createVertexBuffer(const std::vector<VoxelVertex>& vertices, UploadQueue& uploads);
+    void createIndexBuffer(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& translucentIndices, UploadQueue& uploads);
+
+    Device& device;
+
+    std::unique_ptr<Buffer> vertexBuffer;
+    uint32_t vertexCount;
+
+    std::unique_ptr<Buffer> indexBuffer;
+    uint32_t indexCount;
+    uint32_t translucentIndexCount;
+};
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef __VOXEL_RENDER_SYSTEM_HPP__
+#define __VOXEL_RENDER_SYSTEM_HPP__
+
+#include <device.hpp>
+#include <pipeline.hpp>
+#include <frame_info.hpp>
+#include <render_system.hpp>
+
+#include <vulkan/vulkan.h>
+
+#include <memory>
+
+namespace engine {
+
+// Draws the VoxelMesh of every game object with the packed-vertex terrain pipeline. Only
+// transform.translation and the uniform scale transform.scale.x (the block size of LOD
+// meshes) are applied, as the chunk origin push constant; chunk meshes are never rotated.
+class VoxelRenderSystem {
+public:
+    VoxelRenderSystem(Device& deviceRef, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+    ~VoxelRenderSystem();
+
+    VoxelRenderSystem(const VoxelRenderSystem&) = delete;
+    VoxelRenderSystem& operator=(const VoxelRenderSystem&) = delete;
+
+    // Opaque quads in any order. The translucent ranges go after all opaque geometry, chunk
+    // by chunk from the farthest, blended and without depth writes. Stats cover both passes.
+    void render(FrameInfo& frameInfo);
+    void renderTranslucent(FrameInfo& frameInfo);
+
+    const RenderStats& getStats() const { return stats; }
+
+private:
+    void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
+    void createPipeline(VkRenderPass renderPass);
+
+    Device& device;
+
+    std::unique_ptr<Pipeline> pipeline;
+    std::unique_ptr<Pipeline> translucentPipeline;
+    VkPipelineLayout pipelineLayout;
+
+    RenderStats stats{};
+};
+
+} // namespace engine
+
+#endif
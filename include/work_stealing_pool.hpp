@@ -0,0 +1,74 @@
+#ifndef __WORK_STEALING_POOL_HPP__
+#define __WORK_STEALING_POOL_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine {
+
+// General-purpose worker threads for batches of independent CPU work (world generation).
+// Every worker owns a deque: tasks submitted from a worker go to the back of its own deque and
+// are taken back from there (newest first, while their data is still in cache), and a worker
+// that runs dry steals the oldest task of another one. Tasks submitted from other threads are
+// spread round robin. Tasks must not throw.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(unsigned workerCount = getDefaultWorkerCount());
+    ~WorkStealingPool(); // finishes the queued tasks first
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Callable from any thread, including from inside a task
+    void submit(Task task);
+
+    // Blocks until every task submitted so far, and every task those submitted, has finished.
+    // The calling thread runs queued tasks meanwhile. Must not be called from inside a task.
+    void wait();
+
+    // Runs body(0) ... body(count - 1) as separate tasks and waits for all of them (and any
+    // other task in the pool)
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    unsigned getWorkerCount() const { return static_cast<unsigned>(workers.size()); }
+
+    // All hardware threads but the one driving the renderer
+    static unsigned getDefaultWorkerCount();
+
+private:
+    // One cache line each, so workers pushing to their own deque do not contend
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t index);
+    bool takeTask(size_t home, Task& out);
+    void runTask(Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::atomic<size_t> nextQueue{0};      // round robin for submissions from outside the pool
+    std::atomic<size_t> pendingTasks{0};   // submitted and not finished
+    std::atomic<size_t> queuedTasks{0};    // sitting in a deque
+
+    // Only used to park idle workers and waiting threads; the deques have their own locks
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;        // workers
+    std::condition_variable waiterWakeUp;  // threads in wait()
+    std::atomic<bool> stopping{false};
+
+    std::vector<std::thread> workers;
+};
+
+} // namespace engine
+
+#endif
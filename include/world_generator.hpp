@@ -0,0 +1,79 @@
+#ifndef __WORLD_GENERATOR_HPP__
+#define __WORLD_GENERATOR_HPP__
+
+#include <chunk.hpp>
+#include <climate_map.hpp>
+#include <decoration_queue.hpp>
+#include <noise.hpp>
+#include <work_stealing_pool.hpp>
+
+#define GLM_FORCE_CXX17
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace engine {
+
+// Fills chunks from a world seed in four stages:
+//   biome      - the cached ClimateMap gives each column its biome and blended parameters;
+//   heightmap  - the surface height per column, from the blended parameters so biome
+//                borders have no cliffs;
+//   density    - 3D noise carves caves below the surface; then the surface is layered
+//                (grass, dirt, stone) and everything below sea level but above it flooded;
+//   decoration - trees; their blocks outside the chunk go to a DecorationQueue.
+// A chunk depends only on the seed and its coordinate, never on other chunks or on the order
+// chunks are generated in (random draws come from ChunkRandom), so generation can be spread
+// over any number of threads. The decorations of the neighbors are added when the chunk is
+// finalized (DecorationQueue::apply). Thread-safe: all members are const.
+class WorldGenerator {
+public:
+    // World y of the water surface; +y points down, so lower y is higher terrain
+    static constexpr int SEA_LEVEL = 8;
+    // The surface is kept within [MIN_SURFACE, MAX_SURFACE]
+    static constexpr int MIN_SURFACE = SEA_LEVEL - 36;
+    static constexpr int MAX_SURFACE = SEA_LEVEL + 20;
+
+    explicit WorldGenerator(uint64_t seed, NoiseBackend backend = Noise::getBestBackend());
+
+    // Decoration blocks that fall into other chunks are pushed to decorations; the ones
+    // already waiting there for this chunk are left for DecorationQueue::apply
+    void generate(glm::ivec3 chunkCoord, Chunk& chunk, DecorationQueue& decorations) const;
+
+    // Generates every (coordinate, chunk) pair on the pool, then finalizes them all with the
+    // decorations they received, and blocks until done. Writes into chunks outside the batch
+    // stay queued. The chunks must be distinct and stay alive until then.
+    void generate(WorkStealingPool& pool, const std::vector<std::pair<glm::ivec3, Chunk*>>& chunks,
+        DecorationQueue& decorations) const;
+
+    uint64_t getSeed() const { return seed; }
+    const ClimateMap& getClimate() const { return climate; }
+
+private:
+    static constexpr size_t COLUMNS = Chunk::LENGTH * Chunk::LENGTH;
+
+    // Per column of a chunk, at [x + z * Chunk::LENGTH]
+    struct ColumnData {
+        std::array<Biome, COLUMNS> biomes;
+        std::array<int, COLUMNS> surfaces; // world y of the top solid block
+        std::array<float, COLUMNS> treeChances;
+    };
+
+    void generateColumns(glm::ivec2 origin, ColumnData& columns) const;
+    void carveCaves(glm::ivec3 origin, const ColumnData& columns, BlockType* blocks) const;
+    void plantTrees(glm::ivec3 chunkCoord, const ColumnData& columns, BlockType* blocks, DecorationQueue& decorations) const;
+
+    uint64_t seed;
+    ClimateMap climate;
+    Noise hillNoise;
+    Noise ridgeNoise;
+    Noise caveNoise;
+};
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef __WORLD_STORAGE_HPP__
+#define __WORLD_STORAGE_HPP__
+
+#include <async_file_io.hpp>
+#include <chunk.hpp>
+#include <region_file.hpp>
+
+#define GLM_FORCE_CXX17
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace engine {
+
+// Saved chunks of one world: a directory of region files, r.<x>.<z>.region, each holding the
+// chunks of RegionFile::LENGTH^2 columns encoded by ChunkCodec. Open regions are kept in an LRU cache of at most
+// capacity files. Thread-safe.
+//
+// The asynchronous calls batch their reads and writes into one AsyncFileIo submission, so
+// streaming never blocks a thread on the disk. A chunk saved asynchronously reads back as
+// saved while its write is still in flight.
+class WorldStorage {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 16; // open region files
+
+    // The chunk's ChunkCodec payload, empty if it was never saved or could not be read (the
+    // reason goes to std::cerr). Runs on an I/O thread, so it should hand the decoding on.
+    using LoadCallback = std::function<void(glm::ivec3 chunkCoord, std::vector<uint8_t>&& payload)>;
+
+    // Creates the directory if needed; region files are created on first save
+    explicit WorldStorage(const std::string& directory, size_t capacity = DEFAULT_CAPACITY,
+        IoBackend backend = AsyncFileIo::getBestBackend());
+
+    WorldStorage(const WorldStorage&) = delete;
+    WorldStorage& operator=(const WorldStorage&) = delete;
+
+    // Replaces chunk with the saved copy; returns false, leaving it untouched, if there is none
+    bool load(glm::ivec3 chunkCoord, Chunk& chunk) const;
+    // Chunks outside the vertical extent of a region column (RegionFile::isStorable) are refused
+    void save(glm::ivec3 chunkCoord, const Chunk& chunk);
+
+    // Calls done once per chunk: on this thread for chunks without a saved copy on disk, on an
+    // I/O thread for the rest
+    void loadAsync(const std::vector<glm::ivec3>& chunkCoords, const LoadCallback& done);
+    // Encodes the chunks on this thread; each keeps its previous copy until its write completes
+    void saveAsync(const std::vector<std::pair<glm::ivec3, const Chunk*>>& chunks);
+    // Blocks until every asynchronous load has called back and every asynchronous save is done
+    void wait();
+
+    // Waits, then writes every open region back to disk. Saves, synchronous or not, are only
+    // sure to survive a system crash once this returns (see RegionFile).
+    void flush();
+
+    // Files of the world that are not per chunk, next to the regions. saveFile writes a
+    // temporary file and renames it over the old one, so a crash leaves either copy whole.
+    void saveFile(const std::string& name, const std::vector<uint8_t>& data);
+    // Returns false, leaving data untouched, if the file does not exist
+    bool loadFile(const std::string& name, std::vector<uint8_t>& data) const;
+
+    const std::string& getDirectory() const { return directory; }
+
+private:
+    // Opens (and with create, creates) the region file; nullptr if it does not exist
+    std::shared_ptr<RegionFile> getRegion(glm::ivec2 regionCoord, bool create) const;
+    std::string getRegionPath(glm::ivec2 regionCoord) const;
+
+    // An asynchronous save not completed yet; a newer save of the chunk supersedes it
+    struct PendingWrite {
+        uint64_t sequence;
+        std::shared_ptr<const std::vector<uint8_t>> payload;
+    };
+
+    std::string directory;
+    const size_t capacity;
+
+    // Regions in use stay open through their shared_ptr even if evicted meanwhile
+    mutable std::mutex cacheMutex;
+    mutable std::list<std::pair<glm::ivec2, std::shared_ptr<RegionFile>>> recentRegions; // most recently used first
+    mutable std::unordered_map<glm::ivec2, decltype(recentRegions)::iterator> openRegions;
+    mutable std::unordered_map<glm::ivec2, std::weak_ptr<RegionFile>> evictedRegions;
+
+    mutable std::mutex writesMutex;
+    std::unordered_map<glm::ivec3, PendingWrite> pendingWrites;
+    uint64_t nextWriteSequence = 0;
+
+    AsyncFileIo io; // last, so it completes the requests that use the members above first
+};
+
+} // namespace engine
+
+#endif
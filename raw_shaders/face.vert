@@ -0,0 +1,103 @@
+#version 450
+
+// Vertex pulling: 6 vertices per VoxelFace record (see face_mesh.hpp), no vertex input
+layout(location = 0) out vec4 fragColor; // alpha < 1 for translucent blocks
+layout(location = 1) out vec3 fragPosWorld;
+layout(location = 2) out vec3 fragNormalWorld;
+
+struct PointLight {
+    vec4 position; // ignore w
+    vec4 color; // w is intensity
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+    mat4 projection;
+    mat4 view;
+    mat4 invView;
+    vec4 ambientLightColor; // w is intensity
+    PointLight pointLights[10];
+    int numLights;
+} ubo;
+
+layout(set = 1, binding = 0) readonly buffer FaceBuffer {
+    uvec2 faces[]; // x: position, face and size, y: block type and corner AO
+} faceBuffer;
+
+layout(push_constant) uniform Push {
+    vec4 chunkOrigin; // w is the size of a block, 2^level for LOD meshes
+} push;
+
+// Corner of the quad for each of the 6 vertices of its two triangles, split along either
+// diagonal (QUAD_INDICES in chunk_mesher.cpp)
+const int QUAD_CORNERS[12] = int[](
+    0, 1, 2, 0, 2, 3,
+    1, 2, 3, 1, 3, 0
+);
+
+// Unit cube corners of each Face, same order as FACE_CORNERS in chunk_mesher.cpp
+const vec3 FACE_CORNERS[24] = vec3[](
+    vec3(0, 0, 0), vec3(0, 0, 1), vec3(0, 1, 1), vec3(0, 1, 0),
+    vec3(1, 0, 0), vec3(1, 1, 0), vec3(1, 1, 1), vec3(1, 0, 1),
+    vec3(0, 0, 0), vec3(1, 0, 0), vec3(1, 0, 1), vec3(0, 0, 1),
+    vec3(0, 1, 0), vec3(0, 1, 1), vec3(1, 1, 1), vec3(1, 1, 0),
+    vec3(0, 0, 0), vec3(0, 1, 0), vec3(1, 1, 0), vec3(1, 0, 0),
+    vec3(0, 0, 1), vec3(1, 0, 1), vec3(1, 1, 1), vec3(0, 1, 1)
+);
+
+// Indexed by Face
+const vec3 FACE_NORMALS[6] = vec3[](
+    vec3(-1.0, 0.0, 0.0),
+    vec3(1.0, 0.0, 0.0),
+    vec3(0.0, -1.0, 0.0),
+    vec3(0.0, 1.0, 0.0),
+    vec3(0.0, 0.0, -1.0),
+    vec3(0.0, 0.0, 1.0)
+);
+
+// Indexed by BlockType, same values as ChunkMesher::getBlockColor; alpha is the opacity of
+// the translucent types
+const vec4 BLOCK_COLORS[8] = vec4[](
+    vec4(1.0, 0.0, 1.0, 1.0),
+    vec4(0.45, 0.31, 0.18, 1.0),
+    vec4(0.33, 0.60, 0.22, 1.0),
+    vec4(0.50, 0.50, 0.52, 1.0),
+    vec4(0.16, 0.36, 0.70, 0.6),
+    vec4(0.78, 0.88, 0.92, 0.3),
+    vec4(0.40, 0.27, 0.14, 1.0),
+    vec4(0.20, 0.45, 0.15, 1.0)
+);
+
+// Indexed by ambient occlusion level
+const float AO_BRIGHTNESS[4] = float[](1.0, 0.75, 0.55, 0.4);
+
+void main() {
+    uvec2 record = faceBuffer.faces[gl_VertexIndex / 6];
+
+    // Split along the more occluded diagonal, as isQuadFlipped in chunk_mesher.cpp
+    uvec4 cornerAO = uvec4(record.y >> 8, record.y >> 10, record.y >> 12, record.y >> 14) & 3u;
+    int split = cornerAO.x + cornerAO.z < cornerAO.y + cornerAO.w ? 1 : 0;
+    int corner = QUAD_CORNERS[split * 6 + gl_VertexIndex % 6];
+
+    vec3 block = vec3(
+        float(record.x & 31u),
+        float((record.x >> 5) & 31u),
+        float((record.x >> 10) & 31u));
+    uint face = (record.x >> 15) & 7u;
+    float sizeU = float(((record.x >> 18) & 31u) + 1u);
+    float sizeV = float(((record.x >> 23) & 31u) + 1u);
+    uint blockType = record.y & 255u;
+    uint ao = cornerAO[corner];
+
+    // (u, v) are (y, z), (x, z) and (x, y) for faces along x, y and z
+    uint axis = face / 2u;
+    vec3 size = axis == 0u ? vec3(1.0, sizeU, sizeV)
+              : axis == 1u ? vec3(sizeU, 1.0, sizeV)
+              : vec3(sizeU, sizeV, 1.0);
+
+    vec3 positionWorld = push.chunkOrigin.xyz + (block + FACE_CORNERS[face * 4u + uint(corner)] * size) * push.chunkOrigin.w;
+    gl_Position = ubo.projection * ubo.view * vec4(positionWorld, 1.0);
+    fragNormalWorld = FACE_NORMALS[face];
+    fragPosWorld = positionWorld;
+    vec4 color = blockType < 8u ? BLOCK_COLORS[blockType] : BLOCK_COLORS[0];
+    fragColor = vec4(color.rgb * AO_BRIGHTNESS[ao], color.a);
+}
@@ -0,0 +1,69 @@
+#version 450
+
+// Packed VoxelVertex, see voxel_mesh.hpp
+layout(location = 0) in uint packedVertex;
+
+layout(location = 0) out vec4 fragColor; // alpha < 1 for translucent blocks
+layout(location = 1) out vec3 fragPosWorld;
+layout(location = 2) out vec3 fragNormalWorld;
+
+struct PointLight {
+    vec4 position; // ignore w
+    vec4 color; // w is intensity
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+    mat4 projection;
+    mat4 view;
+    mat4 invView;
+    vec4 ambientLightColor; // w is intensity
+    PointLight pointLights[10];
+    int numLights;
+} ubo;
+
+layout(push_constant) uniform Push {
+    vec4 chunkOrigin; // w is the size of a block, 2^level for LOD meshes
+} push;
+
+// Indexed by Face
+const vec3 FACE_NORMALS[6] = vec3[](
+    vec3(-1.0, 0.0, 0.0),
+    vec3(1.0, 0.0, 0.0),
+    vec3(0.0, -1.0, 0.0),
+    vec3(0.0, 1.0, 0.0),
+    vec3(0.0, 0.0, -1.0),
+    vec3(0.0, 0.0, 1.0)
+);
+
+// Indexed by BlockType, same values as ChunkMesher::getBlockColor; alpha is the opacity of
+// the translucent types
+const vec4 BLOCK_COLORS[8] = vec4[](
+    vec4(1.0, 0.0, 1.0, 1.0),
+    vec4(0.45, 0.31, 0.18, 1.0),
+    vec4(0.33, 0.60, 0.22, 1.0),
+    vec4(0.50, 0.50, 0.52, 1.0),
+    vec4(0.16, 0.36, 0.70, 0.6),
+    vec4(0.78, 0.88, 0.92, 0.3),
+    vec4(0.40, 0.27, 0.14, 1.0),
+    vec4(0.20, 0.45, 0.15, 1.0)
+);
+
+// Indexed by ambient occlusion level
+const float AO_BRIGHTNESS[4] = float[](1.0, 0.75, 0.55, 0.4);
+
+void main() {
+    vec3 position = vec3(
+        float(packedVertex & 63u),
+        float((packedVertex >> 6) & 63u),
+        float((packedVertex >> 12) & 63u));
+    uint face = (packedVertex >> 18) & 7u;
+    uint ao = (packedVertex >> 21) & 3u;
+    uint blockType = (packedVertex >> 23) & 255u;
+
+    vec3 positionWorld = push.chunkOrigin.xyz + position * push.chunkOrigin.w;
+    gl_Position = ubo.projection * ubo.view * vec4(positionWorld, 1.0);
+    fragNormalWorld = FACE_NORMALS[face];
+    fragPosWorld = positionWorld;
+    vec4 color = blockType < 8u ? BLOCK_COLORS[blockType] : BLOCK_COLORS[0];
+    fragColor = vec4(color.rgb * AO_BRIGHTNESS[ao], color.a);
+}
@@ -2,27 +2,90 @@
 #include <keyboard_movement_controller.hpp>
 #include <buffer.hpp>
 #include <render_system.hpp>
+#include <voxel_render_system.hpp>
+#include <face_render_system.hpp>
 #include <point_light_system.hpp>
 #include <camera.hpp>
 #include <frame_info.hpp>
 #include <descriptors.hpp>
+#include <chunk.hpp>
+#include <chunk_codec.hpp>
+#include <chunk_mesher.hpp>
+#include <utils.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
 
 namespace engine {
 
+// Above any terrain, so the camera never starts inside the ground
+static glm::vec3 getSpawnPosition() {
+    return {0.f, static_cast<float>(WorldGenerator::MIN_SURFACE - 4), -2.5f};
+}
+
+// A payload from WorldStorage::loadAsync into chunk, on a generation worker. False, leaving
+// chunk untouched, if there is none or it is corrupt: the chunk is generated again instead,
+// since the worker tasks must not throw.
+static bool decodeSavedChunk(glm::ivec3 chunkCoord, const std::vector<uint8_t>& payload, Chunk& chunk) {
+    if (payload.empty()) return false;
+    try {
+        ChunkCodec::decode(payload.data(), payload.size(), chunk);
+        return true;
+    } catch (const std::runtime_error& error) {
+        std::cerr << "Regenerating chunk (" << chunkCoord.x << ", " << chunkCoord.y << ", " << chunkCoord.z
+                  << "): " << error.what() << std::endl;
+        return false;
+    }
+}
+
 App::App() {
     globalPool = 
         DescriptorPool::Builder(device)
             .setMaxSets(SwapChain::MAX_FRAMES_IN_FLIGHT)
             .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, SwapChain::MAX_FRAMES_IN_FLIGHT)
             .build();
+    facePools = std::make_unique<DescriptorPoolManager>(
+        DescriptorPool::Builder(device)
+            .setMaxSets(FACE_MESHES_PER_POOL)
+            .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, FACE_MESHES_PER_POOL));
+    faceSetLayout =
+        DescriptorSetLayout::Builder(device)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+            .build();
+    meshWorkers = std::make_unique<MeshWorkerPool>(TERRAIN_VERTEX_PULLING);
+    generationWorkers = std::make_unique<WorkStealingPool>();
     loadGameObjects();
+    loadChunks(getSpawnPosition());
 }
 
-App::~App() {}
+// Whatever was not saved on eviction is saved now, so edits survive a restart, and so are the
+// decorations still waiting for chunks that are not loaded. The flush also waits for loads
+// still handing chunks to the generation workers, and those are waited for before the
+// decorations are written, as generating queues more.
+App::~App() {
+    std::vector<std::pair<glm::ivec3, const Chunk*>> unsaved;
+    for (const auto& [chunkCoord, loaded] : chunks) {
+        if (loaded.unsaved) unsaved.emplace_back(chunkCoord, &loaded.blocks);
+    }
+    storage.saveAsync(unsaved);
+    storage.flush();
+    generationWorkers->wait();
+
+    std::vector<uint8_t> pendingDecorations;
+    decorations.encode(pendingDecorations);
+    try {
+        storage.saveFile(DECORATIONS_FILE, pendingDecorations);
+    } catch (const std::runtime_error& error) {
+        std::cerr << "Failed to save pending decorations: " << error.what() << std::endl;
+    }
+}
 
 void App::run() {
     std::vector<std::unique_ptr<Buffer>> uboBuffers(SwapChain::MAX_FRAMES_IN_FLIGHT);
@@ -54,6 +117,19 @@ void App::run() {
         globalSetLayout->getDescriptorSetLayout()
     };
 
+    VoxelRenderSystem voxelRenderSystem{
+        device,
+        renderer.getSwapChainRenderPass(),
+        globalSetLayout->getDescriptorSetLayout()
+    };
+
+    FaceRenderSystem faceRenderSystem{
+        device,
+        renderer.getSwapChainRenderPass(),
+        globalSetLayout->getDescriptorSetLayout(),
+        faceSetLayout->getDescriptorSetLayout()
+    };
+
     PointLightSystem pointLightSystem{
         device,
         renderer.getSwapChainRenderPass(),
@@ -63,7 +139,8 @@ void App::run() {
     Camera camera{};
 
     GameObject viewerObject = GameObject::createGameObject();
-    viewerObject.transform.translation.z = -2.5f;
+    viewerObject.transform.translation = getSpawnPosition();
+    glm::vec3 lastViewPosition = viewerObject.transform.translation;
     KeyboardMovementController cameraController{};
 
     std::chrono::time_point currentTime = std::chrono::high_resolution_clock::now();
@@ -71,6 +148,9 @@ void App::run() {
     double lastMouseX = window.getCursorX();
     double lastMouseY = window.getCursorY();
 
+    bool placeWasPressed = false;
+    bool breakWasPressed = false;
+
     while (!window.shouldClose()) {
         glfwPollEvents();
 
@@ -94,7 +174,29 @@ void App::run() {
         camera.setViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
 
         float aspect = renderer.getAspectRatio();
-        camera.setPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 100.f);
+        camera.setPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 512.f);
+
+        // Edit the block a few units in front of the camera, once per key press
+        const bool placePressed = glfwGetKey(window.getGLFWwindow(), cameraController.keys.placeBlock) == GLFW_PRESS;
+        const bool breakPressed = glfwGetKey(window.getGLFWwindow(), cameraController.keys.breakBlock) == GLFW_PRESS;
+        if ((placePressed && !placeWasPressed) || (breakPressed && !breakWasPressed)) {
+            const glm::vec3 forward{camera.getInverseView()[2]};
+            const glm::vec3 target = glm::floor(camera.getPosition() + 3.f * forward);
+            setBlock(glm::ivec3(target), placePressed && !placeWasPressed ? STONE : AIR);
+        }
+        placeWasPressed = placePressed;
+        breakWasPressed = breakPressed;
+
+        ChunkStreamer::View view{};
+        view.position = camera.getPosition();
+        view.direction = glm::vec3{camera.getInverseView()[2]};
+        view.velocity = frameTime > 0.f ? (view.position - lastViewPosition) / frameTime : glm::vec3{0.f};
+        lastViewPosition = view.position;
+
+        streamChunks(view);
+        updateLodLevels(view.position);
+        remeshDirtyChunks(view);
+        uploadChunkMeshes(view.position);
 
         if (VkCommandBuffer commandBuffer = renderer.beginFrame()) {
             int frameIndex = renderer.getFrameIndex();
@@ -119,12 +221,17 @@ void App::run() {
             // render
             renderer.beginSwapChainRenderPass(commandBuffer);
 
-            // order here matters
+            // order here matters: blended geometry goes last, over everything opaque
             renderSystem.renderGameObjects(frameInfo);
+            voxelRenderSystem.render(frameInfo);
+            faceRenderSystem.render(frameInfo);
+            voxelRenderSystem.renderTranslucent(frameInfo);
+            faceRenderSystem.renderTranslucent(frameInfo);
             pointLightSystem.render(frameInfo);
 
             renderer.endSwapChainRenderPass(commandBuffer);
             renderer.endFrame();
+            frameCounter++;
         }
     }
     vkDeviceWaitIdle(device.getLogicalDevice());
@@ -175,4 +282,613 @@ void App::loadGameObjects() {
     }
 }
 
+// The chunks around the spawn point, loaded from storage or generated on all cores before the
+// first frame; the rest stream in around the camera (streamChunks). The reads go out in one
+// batch and each is decoded on the pool as soon as it completes.
+void App::loadChunks(glm::vec3 spawnPosition) {
+    // Decorations left by the last session for chunks it never loaded, before any chunk takes its own
+    std::vector<uint8_t> pendingDecorations;
+    try {
+        if (storage.loadFile(DECORATIONS_FILE, pendingDecorations)) {
+            decorations.decode(pendingDecorations.data(), pendingDecorations.size());
+        }
+    } catch (const std::runtime_error& error) {
+        std::cerr << "Dropping pending decorations: " << error.what() << std::endl;
+    }
+
+    ChunkStreamer::View view{};
+    view.position = spawnPosition;
+    const auto isKnown = [](glm::ivec3) { return false; };
+    const std::vector<glm::ivec3> spawnArea = chunkStreamer.getMissingChunks(view, isKnown, std::numeric_limits<size_t>::max());
+    for (const glm::ivec3& chunkCoord : spawnArea) {
+        chunks[chunkCoord];
+    }
+    // chunks is not modified until both waits return, so the workers may look their chunk up
+    storage.loadAsync(spawnArea, [this](glm::ivec3 chunkCoord, std::vector<uint8_t>&& payload) {
+        if (payload.empty()) return;
+        generationWorkers->submit([this, chunkCoord, payload = std::move(payload)]() {
+            LoadedChunk& loaded = chunks.find(chunkCoord)->second;
+            loaded.unsaved = !decodeSavedChunk(chunkCoord, payload, loaded.blocks);
+        });
+    });
+    storage.wait();
+    generationWorkers->wait();
+
+    std::vector<std::pair<glm::ivec3, Chunk*>> generated;
+    for (const glm::ivec3& chunkCoord : spawnArea) {
+        LoadedChunk& loaded = chunks.find(chunkCoord)->second;
+        if (loaded.unsaved) generated.emplace_back(chunkCoord, &loaded.blocks);
+    }
+    worldGenerator.generate(*generationWorkers, generated, decorations);
+
+    // Stored chunks take what the generated ones, or an earlier session, left for them
+    for (auto& [chunkCoord, loaded] : chunks) {
+        if (decorations.apply(chunkCoord, loaded.blocks)) loaded.unsaved = true;
+        loaded.blocks.clearDirty();
+        loaded.lod.build(loaded.blocks);
+    }
+    bedrockLod.build(bedrock);
+
+    // Meshing starts with the first updateLodLevels, once the camera is known
+}
+
+// Reads run on the storage's I/O threads, decoding and generation on the pool, all in the
+// background, and finished chunks are picked up here on a later frame. Every step has a
+// budget, so a fast camera spreads the work over frames instead of stalling one.
+//
+// Chunks that changed since they were loaded, or were never saved, are saved on the way out.
+// Saving generated chunks too keeps the parts of trees that loaded neighbors grew into them,
+// which regenerating from the seed would not bring back.
+void App::streamChunks(const ChunkStreamer::View& view) {
+    std::vector<GeneratedChunk> finished;
+    {
+        std::lock_guard<std::mutex> lock{generatedMutex};
+        finished.swap(generatedChunks);
+    }
+    for (GeneratedChunk& generated : finished) {
+        generatingChunks.erase(generated.chunkCoord);
+        addGeneratedChunk(generated.chunkCoord, std::move(*generated.blocks), generated.stored);
+    }
+
+    std::vector<glm::ivec3> loadedChunks;
+    loadedChunks.reserve(chunks.size());
+    for (const auto& entry : chunks) {
+        loadedChunks.push_back(entry.first);
+    }
+    const std::vector<glm::ivec3> expired = chunkStreamer.getExpiredChunks(view, loadedChunks, CHUNK_EVICTIONS_PER_FRAME);
+    std::vector<std::pair<glm::ivec3, const Chunk*>> unsaved;
+    for (const glm::ivec3& chunkCoord : expired) {
+        const LoadedChunk& loaded = chunks.find(chunkCoord)->second;
+        if (loaded.unsaved) unsaved.emplace_back(chunkCoord, &loaded.blocks);
+    }
+    storage.saveAsync(unsaved); // encoded before it returns, so the chunks can go
+    for (const glm::ivec3& chunkCoord : expired) {
+        evictChunk(chunkCoord);
+    }
+
+    if (generatingChunks.size() >= MAX_GENERATIONS_IN_FLIGHT) return;
+    const size_t budget = std::min(CHUNK_GENERATIONS_PER_FRAME, MAX_GENERATIONS_IN_FLIGHT - generatingChunks.size());
+    const auto isKnown = [this](glm::ivec3 chunkCoord) {
+        return chunks.count(chunkCoord) != 0 || generatingChunks.count(chunkCoord) != 0;
+    };
+    const std::vector<glm::ivec3> missing = chunkStreamer.getMissingChunks(view, isKnown, budget);
+    generatingChunks.insert(missing.begin(), missing.end());
+    storage.loadAsync(missing, [this](glm::ivec3 chunkCoord, std::vector<uint8_t>&& payload) {
+        generationWorkers->submit([this, chunkCoord, payload = std::move(payload)]() {
+            GeneratedChunk generated{chunkCoord, std::make_unique<Chunk>()};
+            generated.stored = decodeSavedChunk(chunkCoord, payload, *generated.blocks);
+            if (!generated.stored) worldGenerator.generate(chunkCoord, *generated.blocks, decorations);
+            std::lock_guard<std::mutex> lock{generatedMutex};
+            generatedChunks.push_back(std::move(generated));
+        });
+    });
+}
+
+// Finalizes a chunk that finished generating with the decorations its neighbors left for it.
+// The loaded neighbors take the decorations it left for them (remeshed like any other edit).
+// Its own mesh is started by updateLodLevels, like that of every chunk of the spawn area.
+void App::addGeneratedChunk(glm::ivec3 chunkCoord, Chunk&& blocks, bool stored) {
+    LoadedChunk& loaded = chunks[chunkCoord];
+    loaded.blocks = std::move(blocks);
+    loaded.unsaved = decorations.apply(chunkCoord, loaded.blocks) || !stored;
+    loaded.blocks.clearDirty();
+    loaded.lod.build(loaded.blocks);
+
+    for (int dz = -1; dz <= 1; dz++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                auto neighbor = chunks.find(chunkCoord + glm::ivec3{dx, dy, dz});
+                if (neighbor == chunks.end() || neighbor->first == chunkCoord) continue;
+                if (decorations.apply(neighbor->first, neighbor->second.blocks)) neighbor->second.unsaved = true;
+            }
+        }
+    }
+    remeshNeighbors(chunkCoord);
+}
+
+// Saved by the caller first if it has to be (streamChunks)
+void App::evictChunk(glm::ivec3 chunkCoord) {
+    auto loaded = chunks.find(chunkCoord);
+    placeChunkObject(chunkCoord, 0, GameObject::createGameObject());
+    chunks.erase(loaded);
+    pendingRemesh.erase(chunkCoord);
+    remeshNeighbors(chunkCoord);
+}
+
+// Floor division, so block -1 lands in chunk -1 rather than chunk 0
+static int getChunkCoordinate(int block) {
+    const int length = static_cast<int>(Chunk::LENGTH);
+    return (block >= 0 ? block : block - length + 1) / length;
+}
+
+void App::setBlock(glm::ivec3 blockPos, BlockType type) {
+    const glm::ivec3 chunkCoord{
+        getChunkCoordinate(blockPos.x), getChunkCoordinate(blockPos.y), getChunkCoordinate(blockPos.z)};
+    auto loaded = chunks.find(chunkCoord);
+    if (loaded == chunks.end()) return;
+
+    const glm::ivec3 local = blockPos - chunkCoord * static_cast<int>(Chunk::LENGTH);
+    loaded->second.blocks.setBlock(local.x, local.y, local.z, type);
+    loaded->second.unsaved = true;
+}
+
+const Chunk* App::findChunk(glm::ivec3 chunkCoord) const {
+    auto loaded = chunks.find(chunkCoord);
+    return loaded != chunks.end() ? &loaded->second.blocks : nullptr;
+}
+
+static glm::ivec3 getFaceDirection(int face) {
+    glm::ivec3 direction{0};
+    direction[face / 2] = face % 2 == 0 ? -1 : 1;
+    return direction;
+}
+
+// The sections that touch the chunk's faces in the mask (bit per Face)
+static uint64_t getBoundarySections(uint8_t faces) {
+    const int last = static_cast<int>(Chunk::SECTIONS_PER_AXIS) - 1;
+    uint64_t sections = 0;
+    for (int sz = 0; sz <= last; sz++) {
+        for (int sy = 0; sy <= last; sy++) {
+            for (int sx = 0; sx <= last; sx++) {
+                const glm::ivec3 section{sx, sy, sz};
+                for (int face = 0; face < NUMBER_OF_FACES; face++) {
+                    if ((faces >> face & 1) == 0 || section[face / 2] != (face % 2 == 0 ? 0 : last)) continue;
+                    sections |= uint64_t{1} << Chunk::getSectionIndex(sx, sy, sz);
+                }
+            }
+        }
+    }
+    return sections;
+}
+
+// The sections along the side, edge or corner of the chunk in direction (each component -1, 0 or 1)
+static uint64_t getSectionsToward(glm::ivec3 direction) {
+    const int last = static_cast<int>(Chunk::SECTIONS_PER_AXIS) - 1;
+    uint64_t sections = 0;
+    for (int sz = 0; sz <= last; sz++) {
+        for (int sy = 0; sy <= last; sy++) {
+            for (int sx = 0; sx <= last; sx++) {
+                const glm::ivec3 section{sx, sy, sz};
+                bool along = true;
+                for (int axis = 0; axis < 3; axis++) {
+                    if (direction[axis] != 0 && section[axis] != (direction[axis] < 0 ? 0 : last)) along = false;
+                }
+                if (along) sections |= uint64_t{1} << Chunk::getSectionIndex(sx, sy, sz);
+            }
+        }
+    }
+    return sections;
+}
+
+// The loaded chunks around one that was added or evicted were meshed against what was there
+// before; the sections they share a side, edge or corner with are remeshed
+void App::remeshNeighbors(glm::ivec3 chunkCoord) {
+    for (int dz = -1; dz <= 1; dz++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                const glm::ivec3 direction{dx, dy, dz};
+                const glm::ivec3 neighborCoord = chunkCoord + direction;
+                if (neighborCoord == chunkCoord || chunks.count(neighborCoord) == 0) continue;
+                pendingRemesh[neighborCoord] |= getSectionsToward(-direction);
+            }
+        }
+    }
+}
+
+template <typename Neighbors>
+static void closeFaces(Neighbors& neighbors, uint8_t closedFaces) {
+    for (int face = 0; face < NUMBER_OF_FACES; face++) {
+        if ((closedFaces >> face & 1) == 0) continue;
+        const glm::ivec3 direction = getFaceDirection(face);
+        neighbors[Chunk::getNeighborIndex(direction.x, direction.y, direction.z)] = nullptr;
+    }
+}
+
+ChunkNeighborhood::Neighbors App::getNeighbors(glm::ivec3 chunkCoord, uint8_t closedFaces) const {
+    ChunkNeighborhood::Neighbors neighbors{};
+    for (int dz = -1; dz <= 1; dz++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                const Chunk* neighbor = findChunk(chunkCoord + glm::ivec3{dx, dy, dz});
+                if (neighbor == nullptr && dy == 1) neighbor = &bedrock;
+                neighbors[Chunk::getNeighborIndex(dx, dy, dz)] = neighbor;
+            }
+        }
+    }
+    closeFaces(neighbors, closedFaces);
+    return neighbors;
+}
+
+LodNeighborhood::Neighbors App::getLodNeighbors(glm::ivec3 chunkCoord, uint8_t closedFaces) const {
+    LodNeighborhood::Neighbors neighbors{};
+    for (int dz = -1; dz <= 1; dz++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                auto loaded = chunks.find(chunkCoord + glm::ivec3{dx, dy, dz});
+                const ChunkLod* neighbor = loaded != chunks.end() ? &loaded->second.lod : nullptr;
+                if (neighbor == nullptr && dy == 1) neighbor = &bedrockLod;
+                neighbors[Chunk::getNeighborIndex(dx, dy, dz)] = neighbor;
+            }
+        }
+    }
+    closeFaces(neighbors, closedFaces);
+    return neighbors;
+}
+
+static int selectLodLevel(glm::ivec3 chunkCoord, glm::vec3 viewPosition) {
+    const glm::vec3 center = ChunkMesher::getChunkOrigin(chunkCoord) + glm::vec3(Chunk::LENGTH * 0.5f);
+    int level = 0;
+    for (float distance = glm::distance(center, viewPosition); distance >= App::LOD_DISTANCE && level < ChunkLod::LEVELS - 1; distance *= 0.5f) {
+        level++;
+    }
+    return level;
+}
+
+// Where a chunk's mesh of the given level is placed; its blocks are ChunkLod::getScale(level) long
+static glm::vec3 getMeshOrigin(glm::ivec3 chunkCoord, int level) {
+    return level > 0 ? ChunkMesher::getLodOrigin(chunkCoord, level) : ChunkMesher::getChunkOrigin(chunkCoord);
+}
+
+// Chunks next to a chunk of another level are walled off from it on both sides instead of
+// meshed against it: the two meshes disagree about the shared boundary, and either wall
+// covers the gap wherever its own side is solid, so no cracks open up between levels.
+void App::updateLodLevels(glm::vec3 viewPosition) {
+    for (auto& [chunkCoord, loaded] : chunks) {
+        const int level = selectLodLevel(chunkCoord, viewPosition);
+        uint8_t closedFaces = 0;
+        for (int face = 0; face < NUMBER_OF_FACES; face++) {
+            const glm::ivec3 neighborCoord = chunkCoord + getFaceDirection(face);
+            if (chunks.count(neighborCoord) == 0 || selectLodLevel(neighborCoord, viewPosition) == level) continue;
+            closedFaces |= 1u << face;
+        }
+        if (level == loaded.lodLevel && closedFaces == loaded.closedFaces) continue;
+
+        const bool levelChanged = level != loaded.lodLevel;
+        loaded.lodLevel = level;
+        loaded.closedFaces = closedFaces;
+        if (level > 0) {
+            pendingRemesh.emplace(chunkCoord, 0);
+            continue;
+        }
+
+        // Back at full resolution only the sections edited meanwhile and the ones along the
+        // seams that changed are rebuilt
+        const uint64_t sections = loaded.staleSections | getBoundarySections(closedFaces ^ loaded.sectionClosedFaces);
+        if (sections != 0) {
+            pendingRemesh[chunkCoord] |= sections;
+        } else if (levelChanged) {
+            showChunkMesh(chunkCoord, loaded, 0, viewPosition);
+        }
+    }
+}
+
+void App::remeshDirtyChunks(const ChunkStreamer::View& view) {
+    // Collect the whole frame's edits first so every chunk gets at most one job, including
+    // the sections of neighbors (diagonal ones too, for ambient occlusion) that edits reach
+    for (auto& [chunkCoord, loaded] : chunks) {
+        if (!loaded.blocks.isDirty()) continue;
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    const uint64_t sections = loaded.blocks.getDirtyNeighborSections(dx, dy, dz);
+                    const glm::ivec3 neighborCoord = chunkCoord + glm::ivec3{dx, dy, dz};
+                    auto neighbor = chunks.find(neighborCoord);
+                    if (sections == 0 || neighbor == chunks.end()) continue;
+                    pendingRemesh[neighborCoord] |= sections;
+                    neighbor->second.edited = true;
+                }
+            }
+        }
+        loaded.lod.update(loaded.blocks, loaded.blocks.getDirtySections());
+        loaded.blocks.clearDirty();
+    }
+
+    // Chunks the camera is heading for first. A chunk at a coarser level is meshed whole from
+    // its mip chain; the sections asked for are left stale until it comes back to full resolution.
+    std::vector<std::pair<float, glm::ivec3>> order;
+    order.reserve(pendingRemesh.size());
+    for (const auto& [chunkCoord, sections] : pendingRemesh) {
+        order.emplace_back(chunkStreamer.getPriority(view, chunkCoord), chunkCoord);
+    }
+    std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    int submits = 0;
+    for (const auto& [priority, chunkCoord] : order) {
+        if (submits == MESH_SUBMITS_PER_FRAME) break;
+        auto pending = pendingRemesh.find(chunkCoord);
+        LoadedChunk& loaded = chunks.at(chunkCoord);
+        if (loaded.lodLevel > 0) {
+            const uint64_t version = meshWorkers->submitLod(
+                chunkCoord, loaded.lod, getLodNeighbors(chunkCoord, loaded.closedFaces), loaded.lodLevel);
+            if (version == 0) break;
+            loaded.lodVersion = version;
+            loaded.staleSections |= pending->second;
+            submits++;
+        } else if (pending->second != 0) {
+            // A chunk is meshed in one piece, so greedy quads are not cut at the section bounds,
+            // until an edit reaches it; from then on it is kept in sections, all of them built
+            // once, so an edit only rebuilds the sections it touched. A whole-chunk remesh is
+            // skipped when another chunk already shows the same mesh.
+            uint64_t sections = pending->second | loaded.staleSections;
+            const bool whole = !loaded.edited && (sections == Chunk::ALL_SECTIONS || loaded.wholeSubmitted);
+            if (loaded.wholeSubmitted) sections = Chunk::ALL_SECTIONS;
+            const ChunkNeighborhood neighborhood =
+                ChunkNeighborhood::gather(loaded.blocks, getNeighbors(chunkCoord, loaded.closedFaces));
+            const uint64_t contentHash = sections == Chunk::ALL_SECTIONS ? neighborhood.getContentHash(meshWorkers->getDefaultMode()) : 0;
+            if (contentHash != 0 && showCachedMesh(chunkCoord, loaded, contentHash)) {
+                loaded.staleSections = Chunk::ALL_SECTIONS; // the section meshes were never built
+                loaded.cacheKey = 0;
+                pendingRemesh.erase(pending);
+                continue;
+            }
+
+            const uint64_t version =
+                whole ? meshWorkers->submitWhole(chunkCoord, neighborhood) : meshWorkers->submit(chunkCoord, neighborhood, sections);
+            if (version == 0) break;
+            loaded.wholeSubmitted = whole;
+            loaded.staleSections = 0;
+            loaded.sectionClosedFaces = loaded.closedFaces;
+            loaded.cacheKey = contentHash;
+            loaded.cacheKeyVersion = version;
+            submits++;
+        }
+        pendingRemesh.erase(pending);
+    }
+}
+
+// Meshes shown earlier in the frame (by updateLodLevels) are recorded into the same upload
+// batch, submitted at the end, before the frame that draws them
+void App::uploadChunkMeshes(glm::vec3 viewPosition) {
+    meshUploads.collect();
+    // Frame N reuses the fence of frame N - MAX_FRAMES_IN_FLIGHT, so by now those are done
+    retiredChunkObjects.erase(
+        std::remove_if(retiredChunkObjects.begin(), retiredChunkObjects.end(), [this](const auto& retired) {
+            return frameCounter >= retired.first + SwapChain::MAX_FRAMES_IN_FLIGHT;
+        }),
+        retiredChunkObjects.end());
+    for (auto cached = meshCache.begin(); cached != meshCache.end();) {
+        const bool expired = cached->second.faceMesh.expired() && cached->second.voxelMesh.expired();
+        cached = expired ? meshCache.erase(cached) : std::next(cached);
+    }
+
+    int uploads = 0;
+    MeshResult result{};
+    while (uploads < MESH_UPLOADS_PER_FRAME && meshWorkers->tryPopResult(result)) {
+        auto found = chunks.find(result.chunkCoord);
+        if (found == chunks.end()) continue;
+        LoadedChunk& loaded = found->second;
+
+        if (result.lodLevel > 0) {
+            if (result.version != loaded.lodVersion || result.lodLevel != loaded.lodLevel) continue; // superseded
+            loaded.lodFaces = std::move(result.lodFaces);
+            loaded.lodVertices = std::move(result.lodVertices);
+            showChunkMesh(result.chunkCoord, loaded, result.lodLevel, viewPosition);
+            uploads++;
+            continue;
+        }
+
+        // Keep the sections of a newer result that already came in. A mesh in one piece goes
+        // whole or not at all.
+        bool wholeResult = result.sections == Chunk::ALL_SECTIONS;
+        if (result.whole) {
+            if (result.version < *std::max_element(loaded.sectionVersions.begin(), loaded.sectionVersions.end())) continue;
+            loaded.sectionVersions.fill(result.version);
+            loaded.mesh = std::move(result.mesh);
+            loaded.wholeVersion = result.version;
+        }
+        for (uint64_t sections = result.whole ? 0 : result.sections; sections != 0; sections &= sections - 1) {
+            const size_t section = countTrailingZeros(sections);
+            if (result.version < loaded.sectionVersions[section]) {
+                wholeResult = false;
+                continue;
+            }
+            loaded.sectionVersions[section] = result.version;
+            loaded.mesh.faces[section] = std::move(result.mesh.faces[section]);
+            loaded.mesh.vertices[section] = std::move(result.mesh.vertices[section]);
+        }
+        // A mesh in one piece and sections rebuilt over it overlap; wait for the remesh of all
+        // sections that follows it
+        if (loaded.wholeVersion != 0) {
+            const size_t fromWhole = static_cast<size_t>(
+                std::count(loaded.sectionVersions.begin(), loaded.sectionVersions.end(), loaded.wholeVersion));
+            if (fromWhole == 0) loaded.wholeVersion = 0;
+            if (fromWhole != 0 && fromWhole != Chunk::SECTION_COUNT) continue;
+        }
+
+        // Kept for when the chunk comes back to full resolution, or until the stale sections
+        // have been resubmitted
+        if (loaded.lodLevel != 0 || loaded.staleSections != 0) continue;
+
+        // Only the latest whole remesh is known to match the neighborhood hashed for it
+        const bool cacheable = wholeResult && result.version == loaded.cacheKeyVersion;
+        showChunkMesh(result.chunkCoord, loaded, 0, viewPosition, cacheable ? loaded.cacheKey : 0);
+        uploads++;
+    }
+
+    // Sorted meshes have their own budget, so re-sorts never hold back chunks still to appear
+    int sortedUploads = 0;
+    SortJob sorted{};
+    while (sortedUploads < SORTED_UPLOADS_PER_FRAME && meshWorkers->tryPopSorted(sorted)) {
+        auto found = chunks.find(sorted.chunkCoord);
+        if (found == chunks.end()) continue;
+        LoadedChunk& loaded = found->second;
+        if (!loaded.sortPending || sorted.version != loaded.sortVersion) continue; // superseded by a newer mesh or sort
+        loaded.sortPending = false;
+        if (loaded.sortInPlace) {
+            updateTranslucentOrder(sorted);
+        } else {
+            replaceChunkObject(sorted);
+        }
+        sortedUploads++;
+    }
+
+    // Re-sort the translucent quads of nearby chunks the camera has moved away from since their
+    // last sort; the order only changes when the camera crosses the planes of the quads
+    std::vector<std::pair<float, glm::ivec3>> resorts;
+    for (const auto& [chunkCoord, loaded] : chunks) {
+        if (!loaded.hasTranslucent || loaded.sortPending) continue;
+        const glm::vec3 center = ChunkMesher::getChunkOrigin(chunkCoord) + glm::vec3(Chunk::LENGTH * 0.5f);
+        const float distance = glm::distance(center, viewPosition);
+        if (distance > TRANSLUCENT_SORT_RADIUS) continue;
+        // In mesh units, so coarser meshes, whose quads are further apart, are re-sorted less often
+        const glm::vec3 localView =
+            (viewPosition - getMeshOrigin(chunkCoord, loaded.shownLevel)) / ChunkLod::getScale(loaded.shownLevel);
+        if (glm::distance(localView, loaded.sortOrigin) < TRANSLUCENT_SORT_DISTANCE) continue;
+        resorts.emplace_back(distance, chunkCoord);
+    }
+    const size_t resortCount = std::min(resorts.size(), TRANSLUCENT_SORTS_PER_FRAME);
+    std::partial_sort(resorts.begin(), resorts.begin() + resortCount, resorts.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (size_t i = 0; i < resortCount; i++) {
+        const glm::ivec3 chunkCoord = resorts[i].second;
+        LoadedChunk& loaded = chunks.at(chunkCoord);
+        SortJob mesh{};
+        assembleChunkMesh(chunkCoord, loaded, loaded.shownLevel, mesh);
+        // Only the translucent range goes back to the GPU, so the opaque quads stay behind
+        mesh.faces.faces.clear();
+        mesh.vertices.indices.clear();
+        if (!submitTranslucentSort(std::move(mesh), loaded, viewPosition)) break;
+        loaded.sortInPlace = true;
+    }
+
+    meshUploads.submit();
+}
+
+void App::assembleChunkMesh(glm::ivec3 chunkCoord, const LoadedChunk& loaded, int level, SortJob& mesh) const {
+    mesh.chunkCoord = chunkCoord;
+    mesh.lodLevel = level;
+    if (TERRAIN_VERTEX_PULLING) {
+        if (level > 0) {
+            mesh.faces = loaded.lodFaces;
+        } else {
+            loaded.mesh.assemble(mesh.faces);
+        }
+    } else {
+        if (level > 0) {
+            mesh.vertices = loaded.lodVertices;
+        } else {
+            loaded.mesh.assemble(mesh.vertices);
+        }
+    }
+}
+
+// With translucent quads the mesh is shown once a worker has sorted it for the view; only
+// when the sort queue is full does the main thread sort it itself
+void App::showChunkMesh(glm::ivec3 chunkCoord, LoadedChunk& loaded, int level, glm::vec3 viewPosition, uint64_t contentHash) {
+    SortJob mesh{};
+    assembleChunkMesh(chunkCoord, loaded, level, mesh);
+    loaded.shownLevel = level;
+    loaded.hasTranslucent = !mesh.faces.translucentFaces.empty() || !mesh.vertices.translucentIndices.empty();
+    if (loaded.hasTranslucent && submitTranslucentSort(std::move(mesh), loaded, viewPosition)) return;
+    if (loaded.hasTranslucent) {
+        ChunkMesher::sortTranslucentFaces(mesh.faces, loaded.sortOrigin);
+        ChunkMesher::sortTranslucentFaces(mesh.vertices, loaded.sortOrigin);
+    }
+    loaded.sortPending = false;
+    replaceChunkObject(mesh, contentHash);
+}
+
+// Shows the cached mesh for contentHash, if some chunk still holds it
+bool App::showCachedMesh(glm::ivec3 chunkCoord, LoadedChunk& loaded, uint64_t contentHash) {
+    auto cached = meshCache.find(contentHash);
+    if (cached == meshCache.end()) return false;
+
+    GameObject chunkObject = GameObject::createGameObject();
+    chunkObject.faceMesh = cached->second.faceMesh.lock();
+    chunkObject.voxelMesh = cached->second.voxelMesh.lock();
+    if (!chunkObject.faceMesh && !chunkObject.voxelMesh) {
+        meshCache.erase(cached);
+        return false;
+    }
+    loaded.shownLevel = 0;
+    loaded.hasTranslucent = false;
+    loaded.sortPending = false;
+    placeChunkObject(chunkCoord, 0, std::move(chunkObject));
+    return true;
+}
+
+// Supersedes any sort of the chunk still in flight. Sets the sort origin even when the queue
+// is full, so the caller can sort with it instead. The sort brings a new mesh unless the caller
+// sets sortInPlace afterwards.
+bool App::submitTranslucentSort(SortJob&& mesh, LoadedChunk& loaded, glm::vec3 viewPosition) {
+    loaded.sortOrigin = (viewPosition - getMeshOrigin(mesh.chunkCoord, mesh.lodLevel)) / ChunkLod::getScale(mesh.lodLevel);
+    mesh.viewPosition = loaded.sortOrigin;
+    mesh.version = nextSortVersion;
+    if (!meshWorkers->submitSort(std::move(mesh))) return false;
+    loaded.sortVersion = nextSortVersion++;
+    loaded.sortPending = true;
+    loaded.sortInPlace = false;
+    return true;
+}
+
+// Creates the GPU mesh and puts it in place of the chunk's current object. Meshes without
+// translucent quads (whose order is only right for one chunk) go into the mesh cache under
+// contentHash, unless it is 0.
+void App::replaceChunkObject(const SortJob& mesh, uint64_t contentHash) {
+    GameObject chunkObject = GameObject::createGameObject();
+    bool translucent = false;
+    if (TERRAIN_VERTEX_PULLING) {
+        if (!mesh.faces.faces.empty() || !mesh.faces.translucentFaces.empty()) {
+            chunkObject.faceMesh = std::make_shared<FaceMesh>(device, mesh.faces, *faceSetLayout, *facePools, meshUploads);
+        }
+        translucent = !mesh.faces.translucentFaces.empty();
+    } else {
+        if (!mesh.vertices.vertices.empty()) {
+            chunkObject.voxelMesh = std::make_shared<VoxelMesh>(device, mesh.vertices, meshUploads);
+        }
+        translucent = !mesh.vertices.translucentIndices.empty();
+    }
+    if (contentHash != 0 && !translucent && (chunkObject.faceMesh || chunkObject.voxelMesh)) {
+        meshCache[contentHash] = CachedMesh{chunkObject.faceMesh, chunkObject.voxelMesh};
+    }
+    placeChunkObject(mesh.chunkCoord, mesh.lodLevel, std::move(chunkObject));
+}
+
+// Writes a re-sort into the mesh on screen, which holds the same translucent quads: no sort
+// or new mesh of the chunk came in since the sort was submitted
+void App::updateTranslucentOrder(const SortJob& sorted) {
+    auto shown = chunkObjects.find(sorted.chunkCoord);
+    if (shown == chunkObjects.end()) return;
+    GameObject& chunkObject = gameObjects.at(shown->second);
+    if (chunkObject.faceMesh) chunkObject.faceMesh->updateTranslucentFaces(sorted.faces.translucentFaces, meshUploads);
+    if (chunkObject.voxelMesh) chunkObject.voxelMesh->updateTranslucentIndices(sorted.vertices.translucentIndices, meshUploads);
+}
+
+// Retires the chunk's current object, if any, and shows chunkObject instead unless it has no mesh
+void App::placeChunkObject(glm::ivec3 chunkCoord, int level, GameObject chunkObject) {
+    auto previous = chunkObjects.find(chunkCoord);
+    if (previous != chunkObjects.end()) {
+        auto object = gameObjects.find(previous->second);
+        retiredChunkObjects.emplace_back(frameCounter, std::move(object->second));
+        gameObjects.erase(object);
+        chunkObjects.erase(previous);
+    }
+
+    if (!chunkObject.faceMesh && !chunkObject.voxelMesh) return;
+    chunkObject.transform.translation = getMeshOrigin(chunkCoord, level);
+    chunkObject.transform.scale = glm::vec3(ChunkLod::getScale(level));
+    chunkObjects[chunkCoord] = chunkObject.getId();
+    gameObjects.emplace(chunkObject.getId(), std::move(chunkObject));
+}
+
 } // namespace engine
\ No newline at end of file
@@ -0,0 +1,338 @@
+#include <async_file_io.hpp>
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+// Through the raw system calls: liburing is not a dependency
+#if defined(__linux__) && defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#define ENGINE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#endif
+
+namespace engine {
+
+namespace {
+
+// Blocking, until the whole range is transferred or the file ends
+int64_t transfer(const AsyncFileIo::Request& request) {
+    size_t done = 0;
+    while (done < request.size) {
+#ifdef _WIN32
+        OVERLAPPED position{};
+        const uint64_t offset = request.offset + done;
+        position.Offset = static_cast<DWORD>(offset & 0xffffffffu);
+        position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        const DWORD size = static_cast<DWORD>(request.size - done);
+        DWORD transferred = 0;
+        const BOOL ok = request.write ? WriteFile(request.file, request.buffer + done, size, &transferred, &position)
+                                      : ReadFile(request.file, request.buffer + done, size, &transferred, &position);
+        if (!ok) {
+            if (GetLastError() == ERROR_HANDLE_EOF) break;
+            return -static_cast<int64_t>(GetLastError());
+        }
+#else
+        const off_t offset = static_cast<off_t>(request.offset + done);
+        const ssize_t transferred = request.write ? ::pwrite(request.file, request.buffer + done, request.size - done, offset)
+                                                  : ::pread(request.file, request.buffer + done, request.size - done, offset);
+        if (transferred < 0) {
+            if (errno == EINTR) continue;
+            return -errno;
+        }
+#endif
+        if (transferred == 0) break;
+        done += static_cast<size_t>(transferred);
+    }
+    return static_cast<int64_t>(done);
+}
+
+#ifdef ENGINE_IO_URING
+
+// FAST_POLL came with 5.7, after IORING_OP_READ and IORING_OP_WRITE
+constexpr uint32_t REQUIRED_FEATURES = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_FAST_POLL;
+
+int setupRing(unsigned entries, io_uring_params& params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+}
+
+int enterRing(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+#endif
+
+} // namespace
+
+// The submission queue is only written under the mutex; the completion queue is only read by
+// the reaper thread. The kernel side of both is synchronized through acquire/release on the
+// ring indices.
+struct AsyncFileIo::Ring {
+#ifdef ENGINE_IO_URING
+    int fd = -1;
+    void* rings = MAP_FAILED;
+    size_t ringsSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned capacity = 0;   // submission entries, and so requests in flight
+    unsigned unsubmitted = 0; // entries queued since the last io_uring_enter
+
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    explicit Ring(unsigned entries) {
+        io_uring_params params{};
+        fd = setupRing(entries, params);
+        if (fd < 0) {
+            throw std::runtime_error(std::string{"Failed to create io_uring!\tReason: "} + std::strerror(errno));
+        }
+        if ((params.features & REQUIRED_FEATURES) != REQUIRED_FEATURES) {
+            ::close(fd);
+            throw std::runtime_error("io_uring of this kernel is too old!");
+        }
+
+        const size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        const size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        ringsSize = sqSize > cqSize ? sqSize : cqSize;
+        rings = mmap(nullptr, ringsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* entriesView = rings == MAP_FAILED ? MAP_FAILED
+            : mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (entriesView == MAP_FAILED) {
+            const std::string reason = std::strerror(errno);
+            if (rings != MAP_FAILED) munmap(rings, ringsSize);
+            ::close(fd);
+            throw std::runtime_error("Failed to map io_uring!\tReason: " + reason);
+        }
+        sqes = static_cast<io_uring_sqe*>(entriesView);
+
+        uint8_t* base = static_cast<uint8_t*>(rings);
+        sqTail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+        sqArray = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+        sqMask = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+        capacity = params.sq_entries;
+        cqHead = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+    }
+
+    ~Ring() {
+        munmap(sqes, sqesSize);
+        munmap(rings, ringsSize);
+        ::close(fd);
+    }
+
+    // The caller keeps the number queued and not completed within capacity, so the slot is
+    // free: the kernel consumed it at an earlier enter
+    void queue(uint8_t opcode, int file, uint64_t offset, uint8_t* buffer, size_t size, uint64_t userData) {
+        const unsigned tail = *sqTail; // only written by us
+        const unsigned index = tail & sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = file;
+        sqe.off = offset;
+        sqe.addr = reinterpret_cast<uintptr_t>(buffer);
+        sqe.len = static_cast<uint32_t>(size);
+        sqe.user_data = userData;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        unsubmitted++;
+    }
+
+    void submit() {
+        while (unsubmitted > 0) {
+            const int submitted = enterRing(fd, unsubmitted, 0, 0);
+            if (submitted < 0) {
+                // EAGAIN and EBUSY pass once the kernel or the reaper catches up
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+                throw std::runtime_error(std::string{"Failed to submit to io_uring!\tReason: "} + std::strerror(errno));
+            }
+            unsubmitted -= static_cast<unsigned>(submitted);
+        }
+    }
+#endif
+};
+
+bool AsyncFileIo::isBackendSupported(IoBackend backend) {
+    if (backend == IO_BACKEND_THREAD_POOL) return true;
+#ifdef ENGINE_IO_URING
+    // Also refused by seccomp filters of some containers, and by kernel.io_uring_disabled
+    static const bool supported = []() {
+        io_uring_params params{};
+        const int fd = setupRing(2, params);
+        if (fd < 0) return false;
+        ::close(fd);
+        return (params.features & REQUIRED_FEATURES) == REQUIRED_FEATURES;
+    }();
+    return backend == IO_BACKEND_IO_URING && supported;
+#else
+    return false;
+#endif
+}
+
+IoBackend AsyncFileIo::getBestBackend() {
+    static const IoBackend best = isBackendSupported(IO_BACKEND_IO_URING) ? IO_BACKEND_IO_URING : IO_BACKEND_THREAD_POOL;
+    return best;
+}
+
+AsyncFileIo::AsyncFileIo(IoBackend backend, unsigned queueDepth) : backend{backend} {
+    if (!isBackendSupported(backend)) {
+        throw std::runtime_error("I/O backend not supported on this system!");
+    }
+#ifdef ENGINE_IO_URING
+    if (backend == IO_BACKEND_IO_URING) {
+        ring = std::make_unique<Ring>(queueDepth > 0 ? queueDepth : 1);
+        threads.emplace_back(&AsyncFileIo::reapLoop, this);
+        return;
+    }
+#else
+    (void)queueDepth;
+#endif
+    for (unsigned i = 0; i < FALLBACK_THREADS; i++) {
+        threads.emplace_back(&AsyncFileIo::fallbackLoop, this);
+    }
+}
+
+AsyncFileIo::~AsyncFileIo() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+#ifdef ENGINE_IO_URING
+        // The reaper only wakes up for a completion: a no-op without a request stops it
+        if (ring) {
+            ring->queue(IORING_OP_NOP, -1, 0, nullptr, 0, 0);
+            ring->submit();
+        }
+#endif
+    }
+    wakeUp.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void AsyncFileIo::submit(std::vector<Request>&& batch) {
+    if (batch.empty()) return;
+    std::unique_lock<std::mutex> lock{mutex};
+    if (backend == IO_BACKEND_IO_URING) {
+        submitToRing(batch, lock);
+        return;
+    }
+    for (Request& request : batch) {
+        queued.push_back(std::move(request));
+    }
+    inFlight += batch.size();
+    lock.unlock();
+    wakeUp.notify_all();
+}
+
+void AsyncFileIo::wait() {
+    std::unique_lock<std::mutex> lock{mutex};
+    finished.wait(lock, [this]() { return inFlight == 0; });
+}
+
+void AsyncFileIo::submitToRing(std::vector<Request>& batch, std::unique_lock<std::mutex>& lock) {
+#ifdef ENGINE_IO_URING
+    for (Request& request : batch) {
+        assert(request.size <= MAX_REQUEST_SIZE && "AsyncFileIo request too large");
+        if (inFlight == ring->capacity) {
+            ring->submit(); // what is queued must be in flight before we wait for it
+            finished.wait(lock, [this]() { return inFlight < ring->capacity; });
+        }
+        RingRequest* owned = new RingRequest{std::move(request)};
+        ring->queue(owned->request.write ? IORING_OP_WRITE : IORING_OP_READ, owned->request.file, owned->request.offset,
+            owned->request.buffer, owned->request.size, reinterpret_cast<uintptr_t>(owned));
+        inFlight++;
+    }
+    ring->submit();
+#else
+    (void)batch;
+    (void)lock;
+#endif
+}
+
+void AsyncFileIo::reapLoop() {
+#ifdef ENGINE_IO_URING
+    for (;;) {
+        unsigned head = *ring->cqHead; // only written by us
+        const unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            enterRing(ring->fd, 0, 1, IORING_ENTER_GETEVENTS); // EINTR just goes around again
+            continue;
+        }
+        bool stop = false;
+        for (; head != tail; head++) {
+            const io_uring_cqe& cqe = ring->cqes[head & ring->cqMask];
+            RingRequest* pending = reinterpret_cast<RingRequest*>(static_cast<uintptr_t>(cqe.user_data));
+            const int64_t result = cqe.res;
+            __atomic_store_n(ring->cqHead, head + 1, __ATOMIC_RELEASE);
+            if (pending == nullptr) {
+                stop = true;
+                continue;
+            }
+            // A short transfer is not the end of the file (that reads 0): the rest goes back to
+            // the ring, in the slot the request already holds
+            const Request& request = pending->request;
+            if (result > 0 && pending->transferred + static_cast<size_t>(result) < request.size) {
+                pending->transferred += static_cast<size_t>(result);
+                std::lock_guard<std::mutex> lock{mutex};
+                ring->queue(request.write ? IORING_OP_WRITE : IORING_OP_READ, request.file,
+                    request.offset + pending->transferred, request.buffer + pending->transferred,
+                    request.size - pending->transferred, reinterpret_cast<uintptr_t>(pending));
+                ring->submit();
+                continue;
+            }
+            complete(pending->request, result < 0 ? result : static_cast<int64_t>(pending->transferred) + result);
+            delete pending;
+        }
+        if (stop) return;
+    }
+#endif
+}
+
+void AsyncFileIo::fallbackLoop() {
+    for (;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            wakeUp.wait(lock, [this]() { return stopping || !queued.empty(); });
+            if (queued.empty()) return;
+            request = std::move(queued.front());
+            queued.pop_front();
+        }
+        complete(request, transfer(request));
+    }
+}
+
+void AsyncFileIo::complete(Request& request, int64_t result) {
+    if (request.done) request.done(result);
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        inFlight--;
+    }
+    finished.notify_all();
+}
+
+} // namespace engine
@@ -0,0 +1,519 @@
+#include <chunk.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace engine {
+
+// 32 x 32 bit matrix in place: bit j of row i becomes bit i of row j
+static void transpose32(uint32_t* rows) {
+    uint32_t mask = 0x0000ffffu;
+    for (int j = 16; j != 0; j >>= 1, mask ^= mask << j) {
+        for (int k = 0; k < 32; k = (k + j + 1) & ~j) {
+            const uint32_t swapped = ((rows[k] >> j) ^ rows[k + j]) & mask;
+            rows[k] ^= swapped << j;
+            rows[k + j] ^= swapped;
+        }
+    }
+}
+
+template <typename Layout>
+uint32_t BasicChunk<Layout>::addPaletteEntry(BlockType type) {
+    palette.push_back(type);
+    if (isSolid(type) && !isOpaque(type) && opaqueMasks.empty()) {
+        // The new type is not placed yet, so opacity still matches solidity everywhere
+        opaqueMasks = solidMasks;
+    }
+    if (palette.size() > (size_t{1} << bitsPerBlock)) {
+        assert(bitsPerBlock < 8 && "Palette cannot hold more than 256 block types");
+
+        std::vector<uint32_t> identity(palette.size() - 1);
+        for (size_t i = 0; i < identity.size(); i++) {
+            identity[i] = static_cast<uint32_t>(i);
+        }
+        repack(bitsPerBlock * 2, identity);
+    }
+    return static_cast<uint32_t>(palette.size() - 1);
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::expandUniform() {
+    palette.assign(1, uniformBlock);
+    data.assign(SIZE / WORD_BITS, 0);
+    bitsPerBlock = 1;
+
+    solidMasks.assign(3 * COLUMNS, isSolid(uniformBlock) ? ~0u : 0u);
+    opaqueMasks.clear();
+    if (isSolid(uniformBlock) && !isOpaque(uniformBlock)) {
+        opaqueMasks.assign(3 * COLUMNS, 0u);
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::fill(BlockType type) {
+    if (isUniform() && uniformBlock == type) return;
+    releaseStorage(type);
+    markDirty(0, 0, 0, static_cast<int>(LENGTH), static_cast<int>(LENGTH), static_cast<int>(LENGTH));
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::releaseStorage(BlockType type) {
+    uniformBlock = type;
+    bitsPerBlock = 0;
+    palette.clear();
+    palette.shrink_to_fit();
+    data.clear();
+    data.shrink_to_fit();
+    solidMasks.clear();
+    solidMasks.shrink_to_fit();
+    opaqueMasks.clear();
+    opaqueMasks.shrink_to_fit();
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::fill(int minX, int minY, int minZ, int maxX, int maxY, int maxZ, BlockType type) {
+    const int length = static_cast<int>(LENGTH);
+    if (minX < 0 || minY < 0 || minZ < 0 || maxX > length || maxY > length || maxZ > length) {
+        throw std::runtime_error("Access violation: fill(int,int,int,int,int,int,BlockType) box out of bounds!");
+    }
+    if (minX >= maxX || minY >= maxY || minZ >= maxZ) return;
+
+    if (minX == 0 && minY == 0 && minZ == 0 && maxX == length && maxY == length && maxZ == length) {
+        fill(type);
+        return;
+    }
+
+    if (isUniform()) {
+        if (type == uniformBlock) return;
+        expandUniform();
+    }
+    const uint32_t paletteIndex = findOrAddPaletteEntry(type);
+    fillOccupancy(minX, minY, minZ, maxX, maxY, maxZ, type);
+    markDirty(minX, minY, minZ, maxX, maxY, maxZ);
+
+    // In x-major order full rows are contiguous, so whole xy-slabs collapse into a single run
+    if constexpr (Layout::RUN_LENGTH == LENGTH) {
+        if (minX == 0 && maxX == length) {
+            if (minY == 0 && maxY == length) {
+                writeRun(getIndex(0, 0, minZ), (maxZ - minZ) * LENGTH * LENGTH, paletteIndex);
+                return;
+            }
+            for (int z = minZ; z < maxZ; z++) {
+                writeRun(getIndex(0, minY, z), (maxY - minY) * LENGTH, paletteIndex);
+            }
+            return;
+        }
+    }
+
+    for (int z = minZ; z < maxZ; z++) {
+        for (int y = minY; y < maxY; y++) {
+            writeRowRun(minX, y, z, maxX - minX, paletteIndex);
+        }
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::copyFrom(const BasicChunk& src, int srcX, int srcY, int srcZ, int dstX, int dstY, int dstZ, int sizeX, int sizeY, int sizeZ) {
+    if (sizeX <= 0 || sizeY <= 0 || sizeZ <= 0) return;
+    if (!inBounds(srcX, srcY, srcZ) || !inBounds(srcX + sizeX - 1, srcY + sizeY - 1, srcZ + sizeZ - 1)
+        || !inBounds(dstX, dstY, dstZ) || !inBounds(dstX + sizeX - 1, dstY + sizeY - 1, dstZ + sizeZ - 1)) {
+        throw std::runtime_error("Access violation: copyFrom(...) box out of bounds!");
+    }
+
+    if (src.isUniform()) {
+        fill(dstX, dstY, dstZ, dstX + sizeX, dstY + sizeY, dstZ + sizeZ, src.uniformBlock);
+        return;
+    }
+
+    // Source palette indices are translated lazily so unused source entries never reach our palette
+    constexpr uint32_t UNMAPPED = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(src.palette.size(), UNMAPPED);
+    const std::vector<BlockType> srcPalette = src.palette; // copied: src may be *this
+
+    // A row is read whole before it is written, so overlapping boxes of *this only need the
+    // rows in the right order: like memmove, last first when the destination lies ahead
+    const int rows = sizeY * sizeZ;
+    const bool backward = &src == this && (dstZ - srcZ) * static_cast<int>(LENGTH) + (dstY - srcY) > 0;
+    uint8_t indices[LENGTH];
+    for (int i = 0; i < rows; i++) {
+        const int row = backward ? rows - 1 - i : i;
+        const int y = row % sizeY;
+        const int z = row / sizeY;
+        src.readRowPaletteIndices(srcX, srcY + y, srcZ + z, sizeX, indices);
+        if (isUniform()) expandUniform();
+        for (int x = 0; x < sizeX; x++) {
+            uint32_t& paletteIndex = remap[indices[x]];
+            if (paletteIndex == UNMAPPED) {
+                paletteIndex = findOrAddPaletteEntry(srcPalette[indices[x]]);
+            }
+            writePaletteIndex(getIndex(dstX + x, dstY + y, dstZ + z), paletteIndex);
+        }
+    }
+    refreshOccupancy(dstX, dstY, dstZ, dstX + sizeX, dstY + sizeY, dstZ + sizeZ);
+    markDirty(dstX, dstY, dstZ, dstX + sizeX, dstY + sizeY, dstZ + sizeZ);
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::getRow(int y, int z, BlockType* out) const {
+    if (!inBounds(0, y, z)) {
+        throw std::runtime_error("Access violation: getRow(int,int,BlockType*) index out of bounds!");
+    }
+    if (isUniform()) {
+        std::fill(out, out + LENGTH, uniformBlock);
+        return;
+    }
+
+    uint8_t indices[LENGTH];
+    readRowPaletteIndices(0, y, z, LENGTH, indices);
+    for (size_t x = 0; x < LENGTH; x++) {
+        out[x] = palette[indices[x]];
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::setRow(int y, int z, const BlockType* in) {
+    if (!inBounds(0, y, z)) {
+        throw std::runtime_error("Access violation: setRow(int,int,const BlockType*) index out of bounds!");
+    }
+    if (isUniform()) {
+        if (std::all_of(in, in + LENGTH, [this](BlockType type) { return type == uniformBlock; })) return;
+        expandUniform();
+    }
+
+    BlockType lastType = in[0];
+    uint32_t paletteIndex = findOrAddPaletteEntry(lastType);
+    for (size_t x = 0; x < LENGTH; x++) {
+        if (in[x] != lastType) {
+            lastType = in[x];
+            paletteIndex = findOrAddPaletteEntry(lastType);
+        }
+        writePaletteIndex(getIndex(static_cast<int>(x), y, z), paletteIndex);
+    }
+    refreshOccupancy(0, y, z, static_cast<int>(LENGTH), y + 1, z + 1);
+    markDirty(0, y, z, static_cast<int>(LENGTH), y + 1, z + 1);
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::getColumn(int x, int z, BlockType* out) const {
+    if (!inBounds(x, 0, z)) {
+        throw std::runtime_error("Access violation: getColumn(int,int,BlockType*) index out of bounds!");
+    }
+    if (isUniform()) {
+        std::fill(out, out + LENGTH, uniformBlock);
+        return;
+    }
+
+    for (size_t y = 0; y < LENGTH; y++) {
+        out[y] = palette[readPaletteIndex(getIndex(x, static_cast<int>(y), z))];
+    }
+}
+
+template <typename Layout>
+const uint32_t* BasicChunk<Layout>::getSolidColumns(Axis axis) const {
+    static const std::vector<uint32_t> empty(COLUMNS, 0u);
+    static const std::vector<uint32_t> full(COLUMNS, ~0u);
+    if (isUniform()) return isSolid(uniformBlock) ? full.data() : empty.data();
+    return solidMasks.data() + axis * COLUMNS;
+}
+
+template <typename Layout>
+const uint32_t* BasicChunk<Layout>::getOpaqueColumns(Axis axis) const {
+    static const std::vector<uint32_t> empty(COLUMNS, 0u);
+    static const std::vector<uint32_t> full(COLUMNS, ~0u);
+    if (isUniform()) return isOpaque(uniformBlock) ? full.data() : empty.data();
+    if (opaqueMasks.empty()) return solidMasks.data() + axis * COLUMNS;
+    return opaqueMasks.data() + axis * COLUMNS;
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::markDirty(int minX, int minY, int minZ, int maxX, int maxY, int maxZ) {
+    const int length = static_cast<int>(LENGTH);
+    const int sectionLength = static_cast<int>(SECTION_LENGTH);
+    const int grownMin[3] = {minX - 1, minY - 1, minZ - 1};
+    const int grownMax[3] = {maxX + 1, maxY + 1, maxZ + 1};
+
+    // Most writes are away from the chunk faces and only touch this chunk
+    const bool inside = grownMin[0] >= 0 && grownMin[1] >= 0 && grownMin[2] >= 0
+        && grownMax[0] <= length && grownMax[1] <= length && grownMax[2] <= length;
+    const int reach = inside ? 0 : 1;
+
+    for (int dz = -reach; dz <= reach; dz++) {
+        for (int dy = -reach; dy <= reach; dy++) {
+            for (int dx = -reach; dx <= reach; dx++) {
+                // Inclusive section range of the grown box in the coordinates of that chunk
+                const int offset[3] = {dx * length, dy * length, dz * length};
+                int first[3];
+                int last[3];
+                bool overlaps = true;
+                for (int axis = AXIS_X; axis <= AXIS_Z && overlaps; axis++) {
+                    const int low = std::max(grownMin[axis] - offset[axis], 0);
+                    const int high = std::min(grownMax[axis] - offset[axis], length);
+                    overlaps = low < high;
+                    first[axis] = low / sectionLength;
+                    last[axis] = (high - 1) / sectionLength;
+                }
+                if (!overlaps) continue;
+
+                uint64_t& sections = dirtySections[getNeighborIndex(dx, dy, dz)];
+                for (int sz = first[2]; sz <= last[2]; sz++) {
+                    for (int sy = first[1]; sy <= last[1]; sy++) {
+                        for (int sx = first[0]; sx <= last[0]; sx++) {
+                            sections |= uint64_t{1} << getSectionIndex(sx, sy, sz);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::setColumnBits(std::vector<uint32_t>& masks, int minX, int minY, int minZ, int maxX, int maxY, int maxZ, bool value) {
+    auto rangeBits = [](int lo, int hi) {
+        return (hi - lo == 32 ? ~0u : ((1u << (hi - lo)) - 1u)) << lo;
+    };
+    auto apply = [value](uint32_t& mask, uint32_t bits) {
+        mask = value ? (mask | bits) : (mask & ~bits);
+    };
+
+    const uint32_t xBits = rangeBits(minX, maxX);
+    const uint32_t yBits = rangeBits(minY, maxY);
+    const uint32_t zBits = rangeBits(minZ, maxZ);
+    for (int z = minZ; z < maxZ; z++) {
+        for (int y = minY; y < maxY; y++) {
+            apply(masks[AXIS_X * COLUMNS + getColumnIndex(y, z)], xBits);
+        }
+        for (int x = minX; x < maxX; x++) {
+            apply(masks[AXIS_Y * COLUMNS + getColumnIndex(x, z)], yBits);
+        }
+    }
+    for (int y = minY; y < maxY; y++) {
+        for (int x = minX; x < maxX; x++) {
+            apply(masks[AXIS_Z * COLUMNS + getColumnIndex(x, y)], zBits);
+        }
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::fillOccupancy(int minX, int minY, int minZ, int maxX, int maxY, int maxZ, BlockType type) {
+    setColumnBits(solidMasks, minX, minY, minZ, maxX, maxY, maxZ, isSolid(type));
+    if (!opaqueMasks.empty()) {
+        setColumnBits(opaqueMasks, minX, minY, minZ, maxX, maxY, maxZ, isOpaque(type));
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::refreshOccupancy(int minX, int minY, int minZ, int maxX, int maxY, int maxZ) {
+    setColumnBits(solidMasks, minX, minY, minZ, maxX, maxY, maxZ, false);
+    if (!opaqueMasks.empty()) {
+        setColumnBits(opaqueMasks, minX, minY, minZ, maxX, maxY, maxZ, false);
+    }
+
+    uint8_t indices[LENGTH];
+    for (int z = minZ; z < maxZ; z++) {
+        for (int y = minY; y < maxY; y++) {
+            readRowPaletteIndices(minX, y, z, maxX - minX, indices);
+            for (int x = minX; x < maxX; x++) {
+                const BlockType type = palette[indices[x - minX]];
+                if (isSolid(type)) toggleColumnBits(solidMasks, x, y, z);
+                if (!opaqueMasks.empty() && isOpaque(type)) toggleColumnBits(opaqueMasks, x, y, z);
+            }
+        }
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::writeRun(size_t first, size_t count, uint32_t paletteIndex) {
+    const uint64_t pattern = broadcast(paletteIndex);
+    size_t bit = first * bitsPerBlock;
+    const size_t end = (first + count) * bitsPerBlock;
+    while (bit < end) {
+        const size_t shift = bit % WORD_BITS;
+        const size_t span = std::min(WORD_BITS - shift, end - bit);
+        const uint64_t mask = (span == WORD_BITS ? ~uint64_t{0} : ((uint64_t{1} << span) - 1)) << shift;
+        uint64_t& word = data[bit / WORD_BITS];
+        word = (word & ~mask) | (pattern & mask);
+        bit += span;
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::readPaletteIndices(size_t first, size_t count, uint8_t* out) const {
+    const uint64_t mask = indexMask();
+    size_t bit = first * bitsPerBlock;
+    size_t i = 0;
+    while (i < count) {
+        uint64_t word = data[bit / WORD_BITS] >> (bit % WORD_BITS);
+        const size_t n = std::min((WORD_BITS - bit % WORD_BITS) / bitsPerBlock, count - i);
+        for (size_t k = 0; k < n; k++) {
+            out[i++] = static_cast<uint8_t>(word & mask);
+            word >>= bitsPerBlock;
+        }
+        bit += n * bitsPerBlock;
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::writeRowRun(int x, int y, int z, int count, uint32_t paletteIndex) {
+    const int runLength = static_cast<int>(Layout::RUN_LENGTH);
+    const int end = x + count;
+    while (x < end) {
+        const int runEnd = std::min(end, (x / runLength + 1) * runLength);
+        writeRun(getIndex(x, y, z), runEnd - x, paletteIndex);
+        x = runEnd;
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::readRowPaletteIndices(int x, int y, int z, int count, uint8_t* out) const {
+    const int runLength = static_cast<int>(Layout::RUN_LENGTH);
+    const int end = x + count;
+    while (x < end) {
+        const int runEnd = std::min(end, (x / runLength + 1) * runLength);
+        readPaletteIndices(getIndex(x, y, z), runEnd - x, out);
+        out += runEnd - x;
+        x = runEnd;
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::repack(uint8_t newBitsPerBlock, const std::vector<uint32_t>& remap) {
+    std::vector<uint64_t> packed(SIZE * newBitsPerBlock / WORD_BITS, 0);
+    for (size_t i = 0; i < SIZE; i++) {
+        const uint64_t value = remap[readPaletteIndex(i)];
+        const size_t bit = i * newBitsPerBlock;
+        packed[bit / WORD_BITS] |= value << (bit % WORD_BITS);
+    }
+    data = std::move(packed);
+    bitsPerBlock = newBitsPerBlock;
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::compact() {
+    if (isUniform()) return;
+
+    std::vector<bool> used(palette.size(), false);
+    for (size_t i = 0; i < SIZE; i++) {
+        used[readPaletteIndex(i)] = true;
+    }
+
+    std::vector<uint32_t> remap(palette.size(), 0);
+    std::vector<BlockType> compacted;
+    for (size_t i = 0; i < palette.size(); i++) {
+        if (!used[i]) continue;
+        remap[i] = static_cast<uint32_t>(compacted.size());
+        compacted.push_back(palette[i]);
+    }
+
+    if (compacted.size() == 1) {
+        releaseStorage(compacted[0]);
+        return;
+    }
+
+    uint8_t newBitsPerBlock = 1;
+    while (compacted.size() > (size_t{1} << newBitsPerBlock)) {
+        newBitsPerBlock *= 2;
+    }
+
+    repack(newBitsPerBlock, remap);
+    palette = std::move(compacted);
+    palette.shrink_to_fit();
+
+    if (std::all_of(palette.begin(), palette.end(), [](BlockType type) { return isOpaque(type) || !isSolid(type); })) {
+        opaqueMasks.clear();
+        opaqueMasks.shrink_to_fit();
+    }
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::getPaletteIndices(uint8_t* out) const {
+    if (isUniform()) {
+        std::fill(out, out + SIZE, uint8_t{0});
+        return;
+    }
+    readPaletteIndices(0, SIZE, out);
+}
+
+template <typename Layout>
+void BasicChunk<Layout>::setPaletteIndices(const BlockType* types, size_t paletteSize, const uint8_t* indices) {
+    assert(paletteSize >= 1 && paletteSize <= 256 && "setPaletteIndices palette size out of range");
+    if (paletteSize == 1) {
+        fill(types[0]);
+        return;
+    }
+
+    palette.assign(types, types + paletteSize);
+    bitsPerBlock = 1;
+    while (paletteSize > (size_t{1} << bitsPerBlock)) {
+        bitsPerBlock *= 2;
+    }
+    data.assign(SIZE * bitsPerBlock / WORD_BITS, 0);
+    const size_t perWord = WORD_BITS / bitsPerBlock;
+    for (size_t word = 0; word < data.size(); word++) {
+        uint64_t packed = 0;
+        for (size_t k = 0; k < perWord; k++) {
+            assert(indices[word * perWord + k] < paletteSize && "setPaletteIndices index out of range");
+            packed |= static_cast<uint64_t>(indices[word * perWord + k]) << (k * bitsPerBlock);
+        }
+        data[word] = packed;
+    }
+
+    std::array<bool, 256> solid{};
+    std::array<bool, 256> opaque{};
+    for (size_t i = 0; i < paletteSize; i++) {
+        solid[i] = isSolid(types[i]);
+        opaque[i] = isOpaque(types[i]);
+    }
+    buildOccupancy(solidMasks, indices, solid);
+    opaqueMasks.clear();
+    if (solid != opaque) buildOccupancy(opaqueMasks, indices, opaque);
+    const int length = static_cast<int>(LENGTH);
+    markDirty(0, 0, 0, length, length, length);
+}
+
+// The x masks straight from the indices; the y and z masks are the same bits transposed, a
+// 32 x 32 block at a time
+template <typename Layout>
+void BasicChunk<Layout>::buildOccupancy(std::vector<uint32_t>& masks, const uint8_t* indices, const std::array<bool, 256>& set) {
+    const int length = static_cast<int>(LENGTH);
+    masks.assign(3 * COLUMNS, 0u);
+    uint32_t* xMasks = masks.data() + AXIS_X * COLUMNS;
+    for (int z = 0; z < length; z++) {
+        for (int y = 0; y < length; y++) {
+            uint32_t bits = 0;
+            for (int x = 0; x < length; x++) {
+                bits |= static_cast<uint32_t>(set[indices[getIndex(x, y, z)]]) << x;
+            }
+            xMasks[getColumnIndex(y, z)] = bits;
+        }
+    }
+
+    uint32_t rows[LENGTH];
+    for (int v = 0; v < length; v++) {
+        // Rows y of slice z = v, transposed to rows x: the y masks of (x, z)
+        std::copy(xMasks + getColumnIndex(0, v), xMasks + getColumnIndex(0, v) + LENGTH, rows);
+        transpose32(rows);
+        std::copy(rows, rows + LENGTH, masks.data() + AXIS_Y * COLUMNS + getColumnIndex(0, v));
+        // Rows z of slice y = v, transposed to rows x: the z masks of (x, y)
+        for (int z = 0; z < length; z++) {
+            rows[z] = xMasks[getColumnIndex(v, z)];
+        }
+        transpose32(rows);
+        std::copy(rows, rows + LENGTH, masks.data() + AXIS_Z * COLUMNS + getColumnIndex(0, v));
+    }
+}
+
+template <typename Layout>
+size_t BasicChunk<Layout>::getMemoryUsage() const {
+    return sizeof(BasicChunk)
+        + palette.capacity() * sizeof(BlockType)
+        + data.capacity() * sizeof(uint64_t)
+        + (solidMasks.capacity() + opaqueMasks.capacity()) * sizeof(uint32_t);
+}
+
+template class BasicChunk<LinearLayout>;
+template class BasicChunk<MortonLayout>;
+template class BasicChunk<BrickLayout>;
+
+} // namespace engine
@@ -0,0 +1,246 @@
+#include <chunk_codec.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace engine {
+
+namespace {
+
+constexpr uint8_t FLAG_LZ = 1;
+constexpr size_t HEADER_SIZE = 3;  // version, flags, layout ID
+constexpr size_t LZ_SIZE_FIELD = 4; // body size before the LZ pass, after the header
+
+// LZ pass: each sequence is a token (literal count << 4 | match length - MIN_MATCH, either
+// 15 meaning more follows in 255-steps), the literals, then a 16-bit offset and the match
+// unless the input ends after the literals
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 12;
+constexpr uint32_t NO_POSITION = ~uint32_t{0};
+
+// Palette count, the palette, and a run of one block at most every position
+constexpr size_t MAX_BODY_SIZE = 1 + 256 + CHUNK_LENGTH * CHUNK_LENGTH * CHUNK_LENGTH * 4;
+
+[[noreturn]] void fail() {
+    throw std::runtime_error("Corrupt chunk data!");
+}
+
+void writeVarint(std::vector<uint8_t>& out, size_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+size_t readVarint(const uint8_t*& in, const uint8_t* end) {
+    size_t value = 0;
+    for (int shift = 0; shift < 21; shift += 7) {
+        if (in == end) fail();
+        const uint8_t byte = *in++;
+        value |= static_cast<size_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    fail();
+}
+
+uint32_t read32(const uint8_t* in) {
+    uint32_t value;
+    std::memcpy(&value, in, sizeof(value));
+    return value;
+}
+
+void writeExtraLength(std::vector<uint8_t>& out, size_t length) {
+    for (; length >= 255; length -= 255) {
+        out.push_back(255);
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+size_t readExtraLength(const uint8_t*& in, const uint8_t* end) {
+    size_t length = 0;
+    uint8_t byte = 255;
+    while (byte == 255) {
+        if (in == end) fail();
+        byte = *in++;
+        length += byte;
+    }
+    return length;
+}
+
+void writeSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+    const size_t matchCode = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+    out.push_back(static_cast<uint8_t>(std::min<size_t>(literalCount, 15) << 4 | std::min<size_t>(matchCode, 15)));
+    if (literalCount >= 15) writeExtraLength(out, literalCount - 15);
+    out.insert(out.end(), literals, literals + literalCount);
+    if (matchLength == 0) return;
+    out.push_back(static_cast<uint8_t>(offset));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+    if (matchCode >= 15) writeExtraLength(out, matchCode - 15);
+}
+
+// Greedy, one hash table probe per position
+void compressLz(const uint8_t* in, size_t size, std::vector<uint8_t>& out) {
+    std::array<uint32_t, size_t{1} << HASH_BITS> table;
+    table.fill(NO_POSITION);
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + MIN_MATCH <= size) {
+        const uint32_t value = read32(in + i);
+        const uint32_t hash = (value * 2654435761u) >> (32 - HASH_BITS);
+        const uint32_t candidate = table[hash];
+        table[hash] = static_cast<uint32_t>(i);
+        if (candidate == NO_POSITION || i - candidate > MAX_OFFSET || read32(in + candidate) != value) {
+            i++;
+            continue;
+        }
+        size_t length = MIN_MATCH;
+        while (i + length < size && in[candidate + length] == in[i + length]) {
+            length++;
+        }
+        writeSequence(out, in + anchor, i - anchor, i - candidate, length);
+        i += length;
+        anchor = i;
+    }
+    if (anchor < size) writeSequence(out, in + anchor, size - anchor, 0, 0);
+}
+
+void decompressLz(const uint8_t* in, const uint8_t* end, uint8_t* out, size_t size) {
+    size_t written = 0;
+    while (in < end) {
+        const uint8_t token = *in++;
+        size_t literalCount = token >> 4;
+        if (literalCount == 15) literalCount += readExtraLength(in, end);
+        if (literalCount > static_cast<size_t>(end - in) || literalCount > size - written) fail();
+        std::memcpy(out + written, in, literalCount);
+        in += literalCount;
+        written += literalCount;
+        if (in == end) break;
+
+        if (end - in < 2) fail();
+        const size_t offset = in[0] | static_cast<size_t>(in[1]) << 8;
+        in += 2;
+        size_t length = (token & 15) + MIN_MATCH;
+        if ((token & 15) == 15) length += readExtraLength(in, end);
+        if (offset == 0 || offset > written || length > size - written) fail();
+        // Byte by byte: a match may overlap the bytes it produces
+        for (size_t k = 0; k < length; k++, written++) {
+            out[written] = out[written - offset];
+        }
+    }
+    if (written != size) fail();
+}
+
+size_t getLayoutIndex(uint8_t layout, int x, int y, int z) {
+    switch (layout) {
+        case LinearLayout::ID: return LinearLayout::index(x, y, z);
+        case MortonLayout::ID: return MortonLayout::index(x, y, z);
+        case BrickLayout::ID: return BrickLayout::index(x, y, z);
+        default: fail();
+    }
+}
+
+} // namespace
+
+template <typename Layout>
+void ChunkCodec::encode(const BasicChunk<Layout>& chunk, std::vector<uint8_t>& out, bool compress) {
+    std::vector<uint8_t> indices(BasicChunk<Layout>::SIZE);
+    chunk.getPaletteIndices(indices.data());
+
+    std::vector<uint8_t> body;
+    const size_t paletteSize = chunk.getPaletteSize();
+    body.push_back(static_cast<uint8_t>(paletteSize - 1));
+    for (size_t i = 0; i < paletteSize; i++) {
+        body.push_back(chunk.getPaletteEntry(i));
+    }
+    for (size_t first = 0; first < indices.size();) {
+        size_t last = first + 1;
+        while (last < indices.size() && indices[last] == indices[first]) {
+            last++;
+        }
+        writeVarint(body, last - first);
+        body.push_back(indices[first]);
+        first = last;
+    }
+
+    out.assign({VERSION, 0, Layout::ID});
+    if (compress) {
+        const uint32_t bodySize = static_cast<uint32_t>(body.size());
+        out.resize(HEADER_SIZE + LZ_SIZE_FIELD);
+        std::memcpy(out.data() + HEADER_SIZE, &bodySize, sizeof(bodySize));
+        compressLz(body.data(), body.size(), out);
+        if (out.size() < HEADER_SIZE + body.size()) {
+            out[1] = FLAG_LZ;
+            return;
+        }
+        out.resize(HEADER_SIZE);
+    }
+    out.insert(out.end(), body.begin(), body.end());
+}
+
+template <typename Layout>
+void ChunkCodec::decode(const uint8_t* data, size_t size, BasicChunk<Layout>& chunk) {
+    if (size < HEADER_SIZE || data[0] != VERSION || (data[1] & ~FLAG_LZ) != 0) fail();
+    const uint8_t layout = data[2];
+
+    std::vector<uint8_t> inflated;
+    const uint8_t* in = data + HEADER_SIZE;
+    const uint8_t* end = data + size;
+    if (data[1] & FLAG_LZ) {
+        if (end - in < static_cast<std::ptrdiff_t>(LZ_SIZE_FIELD)) fail();
+        const size_t bodySize = read32(in);
+        if (bodySize > MAX_BODY_SIZE) fail();
+        inflated.resize(bodySize);
+        decompressLz(in + LZ_SIZE_FIELD, end, inflated.data(), bodySize);
+        in = inflated.data();
+        end = in + bodySize;
+    }
+
+    if (in == end) fail();
+    const size_t paletteSize = static_cast<size_t>(*in++) + 1;
+    if (static_cast<size_t>(end - in) < paletteSize) fail();
+    std::array<BlockType, 256> palette;
+    std::array<bool, NUMBER_OF_TYPES> seen{};
+    for (size_t i = 0; i < paletteSize; i++) {
+        const uint8_t type = *in++;
+        if (type >= NUMBER_OF_TYPES || seen[type]) fail();
+        seen[type] = true;
+        palette[i] = static_cast<BlockType>(type);
+    }
+
+    std::vector<uint8_t> indices(BasicChunk<Layout>::SIZE);
+    size_t filled = 0;
+    while (in < end) {
+        const size_t length = readVarint(in, end);
+        if (in == end || length == 0 || length > indices.size() - filled || *in >= paletteSize) fail();
+        std::memset(indices.data() + filled, *in++, length);
+        filled += length;
+    }
+    if (filled != indices.size()) fail();
+
+    if (layout != Layout::ID) {
+        std::vector<uint8_t> reordered(indices.size());
+        const int length = static_cast<int>(CHUNK_LENGTH);
+        for (int z = 0; z < length; z++) {
+            for (int y = 0; y < length; y++) {
+                for (int x = 0; x < length; x++) {
+                    reordered[Layout::index(x, y, z)] = indices[getLayoutIndex(layout, x, y, z)];
+                }
+            }
+        }
+        indices.swap(reordered);
+    }
+    chunk.setPaletteIndices(palette.data(), paletteSize, indices.data());
+}
+
+template void ChunkCodec::encode(const BasicChunk<LinearLayout>&, std::vector<uint8_t>&, bool);
+template void ChunkCodec::encode(const BasicChunk<MortonLayout>&, std::vector<uint8_t>&, bool);
+template void ChunkCodec::encode(const BasicChunk<BrickLayout>&, std::vector<uint8_t>&, bool);
+template void ChunkCodec::decode(const uint8_t*, size_t, BasicChunk<LinearLayout>&);
+template void ChunkCodec::decode(const uint8_t*, size_t, BasicChunk<MortonLayout>&);
+template void ChunkCodec::decode(const uint8_t*, size_t, BasicChunk<BrickLayout>&);
+
+} // namespace engine
@@ -0,0 +1,128 @@
+#include <chunk_lod.hpp>
+#include <utils.hpp>
+
+#include <array>
+#include <cassert>
+
+namespace engine {
+
+namespace {
+
+// children in tie-break order, top (-y) first
+BlockType reduceCell(const BlockType (&children)[8]) {
+    std::array<uint8_t, NUMBER_OF_TYPES> counts{};
+    int solid = 0;
+    for (BlockType child : children) {
+        if (!isSolid(child)) continue;
+        counts[child]++;
+        solid++;
+    }
+    if (solid < 4) return AIR;
+
+    BlockType best = AIR;
+    for (BlockType child : children) {
+        if (isSolid(child) && (best == AIR || counts[child] > counts[best])) best = child;
+    }
+    return best;
+}
+
+} // namespace
+
+void ChunkLod::build(const Chunk& chunk) {
+    for (int level = 1; level < LEVELS; level++) {
+        const int length = getLength(level);
+        cells[level].assign(static_cast<size_t>(length) * length * length, AIR);
+    }
+    const int length = getLength(1);
+    reduceChunk(chunk, 0, 0, 0, length, length, length);
+    for (int level = 2; level < LEVELS; level++) {
+        const int levelLength = getLength(level);
+        reduceLevel(level, 0, 0, 0, levelLength, levelLength, levelLength);
+    }
+}
+
+void ChunkLod::update(const Chunk& chunk, uint64_t sections) {
+    if (cells[1].empty()) {
+        build(chunk);
+        return;
+    }
+
+    const int sectionLength = static_cast<int>(Chunk::SECTION_LENGTH);
+    const int sectionsPerAxis = static_cast<int>(Chunk::SECTIONS_PER_AXIS);
+    for (; sections != 0; sections &= sections - 1) {
+        const int section = countTrailingZeros(sections);
+        const int minX = (section % sectionsPerAxis) * sectionLength;
+        const int minY = ((section / sectionsPerAxis) % sectionsPerAxis) * sectionLength;
+        const int minZ = (section / (sectionsPerAxis * sectionsPerAxis)) * sectionLength;
+        reduceChunk(chunk, minX >> 1, minY >> 1, minZ >> 1,
+            (minX + sectionLength) >> 1, (minY + sectionLength) >> 1, (minZ + sectionLength) >> 1);
+        for (int level = 2; level < LEVELS; level++) {
+            reduceLevel(level, minX >> level, minY >> level, minZ >> level,
+                (minX + sectionLength) >> level, (minY + sectionLength) >> level, (minZ + sectionLength) >> level);
+        }
+    }
+}
+
+void ChunkLod::reduceChunk(const Chunk& chunk, int minX, int minY, int minZ, int maxX, int maxY, int maxZ) {
+    const int length = getLength(1);
+    std::array<std::array<BlockType, Chunk::LENGTH>, 4> rows; // (dy, dz) = (0, 0), (0, 1), (1, 0), (1, 1)
+    for (int z = minZ; z < maxZ; z++) {
+        for (int y = minY; y < maxY; y++) {
+            for (int row = 0; row < 4; row++) {
+                chunk.getRow(2 * y + row / 2, 2 * z + row % 2, rows[row].data());
+            }
+            for (int x = minX; x < maxX; x++) {
+                const BlockType children[8] = {
+                    rows[0][2 * x], rows[0][2 * x + 1], rows[1][2 * x], rows[1][2 * x + 1],
+                    rows[2][2 * x], rows[2][2 * x + 1], rows[3][2 * x], rows[3][2 * x + 1],
+                };
+                cells[1][x + (y + z * length) * length] = reduceCell(children);
+            }
+        }
+    }
+}
+
+void ChunkLod::reduceLevel(int level, int minX, int minY, int minZ, int maxX, int maxY, int maxZ) {
+    const int length = getLength(level);
+    for (int z = minZ; z < maxZ; z++) {
+        for (int y = minY; y < maxY; y++) {
+            for (int x = minX; x < maxX; x++) {
+                const BlockType children[8] = {
+                    getCell(level - 1, 2 * x, 2 * y, 2 * z), getCell(level - 1, 2 * x + 1, 2 * y, 2 * z),
+                    getCell(level - 1, 2 * x, 2 * y, 2 * z + 1), getCell(level - 1, 2 * x + 1, 2 * y, 2 * z + 1),
+                    getCell(level - 1, 2 * x, 2 * y + 1, 2 * z), getCell(level - 1, 2 * x + 1, 2 * y + 1, 2 * z),
+                    getCell(level - 1, 2 * x, 2 * y + 1, 2 * z + 1), getCell(level - 1, 2 * x + 1, 2 * y + 1, 2 * z + 1),
+                };
+                cells[level][x + (y + z * length) * length] = reduceCell(children);
+            }
+        }
+    }
+}
+
+LodNeighborhood LodNeighborhood::gather(const ChunkLod& lod, const Neighbors& neighbors, int level) {
+    assert(level >= 1 && level < ChunkLod::LEVELS && "LodNeighborhood level out of range");
+    LodNeighborhood neighborhood{};
+    neighborhood.level = level;
+    const int length = ChunkLod::getLength(level);
+    const int size = neighborhood.getSize();
+    neighborhood.cells.assign(static_cast<size_t>(size) * size * size, AIR);
+
+    // Offset (-1, 0 or 1) of the chunk holding local cell coordinate c along one axis
+    auto side = [length](int c) { return c < 0 ? -1 : (c >= length ? 1 : 0); };
+    for (int z = 0; z < size; z++) {
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                const int dx = side(x - 1);
+                const int dy = side(y - 1);
+                const int dz = side(z - 1);
+                const ChunkLod* source = dx == 0 && dy == 0 && dz == 0 ? &lod : neighbors[Chunk::getNeighborIndex(dx, dy, dz)];
+                if (source == nullptr) continue;
+                neighborhood.cells[x + (y + z * size) * size] =
+                    source->getCell(level, x - 1 - dx * length, y - 1 - dy * length, z - 1 - dz * length);
+            }
+        }
+    }
+    return neighborhood;
+}
+
+} // namespace engine
@@ -0,0 +1,827 @@
+#include <chunk_mesher.hpp>
+#include <utils.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+namespace engine {
+
+namespace {
+
+constexpr int FACE_DIRECTIONS[NUMBER_OF_FACES][3] = {
+    {-1, 0, 0}, {1, 0, 0},
+    {0, -1, 0}, {0, 1, 0},
+    {0, 0, -1}, {0, 0, 1},
+};
+
+// Unit cube corners of each face, ordered so cross(c1 - c0, c2 - c0) is the outward normal
+// (counter-clockwise on screen, which is what the default pipeline keeps)
+constexpr int FACE_CORNERS[NUMBER_OF_FACES][4][3] = {
+    {{0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0}},
+    {{1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1}},
+    {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}},
+    {{0, 1, 0}, {0, 1, 1}, {1, 1, 1}, {1, 1, 0}},
+    {{0, 0, 0}, {0, 1, 0}, {1, 1, 0}, {1, 0, 0}},
+    {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}},
+};
+
+// Chunk coordinates of the (u, v) position in layer d of the given axis
+glm::ivec3 toChunkCoords(int axis, int d, int u, int v) {
+    switch (axis) {
+        case AXIS_X: return {d, u, v};
+        case AXIS_Y: return {u, d, v};
+        default:     return {u, v, d};
+    }
+}
+
+// Ambient occlusion level of corner (0-3) in a per-face AO word, 2 bits per corner
+uint32_t getCornerAO(uint32_t cornerAO, int corner) { return (cornerAO >> (2 * corner)) & 0x3; }
+
+// Quads are split along the diagonal with more occlusion at its ends, so a darkened corner
+// fades out the same way in both triangles. The other split gives an AO gradient that
+// changes with the quad's orientation.
+bool isQuadFlipped(uint32_t cornerAO) {
+    return getCornerAO(cornerAO, 0) + getCornerAO(cornerAO, 2) < getCornerAO(cornerAO, 1) + getCornerAO(cornerAO, 3);
+}
+
+// Two triangles per quad, counter-clockwise like the corners; must match QUAD_CORNERS in face.vert
+constexpr uint32_t QUAD_INDICES[2][6] = {
+    {0, 1, 2, 0, 2, 3},
+    {1, 2, 3, 1, 3, 0},
+};
+
+// Indexed by ambient occlusion level, same values as AO_BRIGHTNESS in the voxel shaders
+constexpr float AO_BRIGHTNESS[4] = {1.f, 0.75f, 0.55f, 0.4f};
+
+// A face is drawn unless the block in front hides it: an opaque block, or more of the same
+// translucent type (no walls inside a body of water)
+bool isFaceVisible(BlockType type, BlockType neighbor) {
+    return isSolid(type) && !isOpaque(neighbor) && !(isTranslucent(type) && neighbor == type);
+}
+
+// Appends a quad covering sizeU x sizeV block faces, starting at block (x, y, z). cornerAO
+// holds the ambient occlusion of the 4 corners in FACE_CORNERS order (see getFaceAO).
+// Translucent quads go into the builder's translucent range (Model has none).
+void appendQuad(Model::Builder& builder, int x, int y, int z, int face, BlockType type, uint32_t cornerAO, int sizeU = 1, int sizeV = 1) {
+    const uint32_t firstVertex = static_cast<uint32_t>(builder.vertices.size());
+    const int axis = face / 2;
+    const glm::vec3 color = ChunkMesher::getBlockColor(type);
+    const glm::vec3 normal(FACE_DIRECTIONS[face][0], FACE_DIRECTIONS[face][1], FACE_DIRECTIONS[face][2]);
+    const glm::ivec3 size = toChunkCoords(axis, 1, sizeU, sizeV);
+
+    for (int corner = 0; corner < 4; corner++) {
+        const glm::ivec3 offset{
+            FACE_CORNERS[face][corner][0] * size.x,
+            FACE_CORNERS[face][corner][1] * size.y,
+            FACE_CORNERS[face][corner][2] * size.z,
+        };
+
+        Model::Vertex vertex{};
+        vertex.position = glm::vec3(glm::ivec3{x, y, z} + offset);
+        vertex.color = color * AO_BRIGHTNESS[getCornerAO(cornerAO, corner)];
+        vertex.normal = normal;
+        switch (axis) {
+            case AXIS_X: vertex.uv = {static_cast<float>(offset.y), static_cast<float>(offset.z)}; break;
+            case AXIS_Y: vertex.uv = {static_cast<float>(offset.x), static_cast<float>(offset.z)}; break;
+            default:     vertex.uv = {static_cast<float>(offset.x), static_cast<float>(offset.y)}; break;
+        }
+        builder.vertices.push_back(vertex);
+    }
+
+    for (uint32_t index : QUAD_INDICES[isQuadFlipped(cornerAO)]) {
+        builder.indices.push_back(firstVertex + index);
+    }
+}
+
+void appendQuad(VoxelMesh::Builder& builder, int x, int y, int z, int face, BlockType type, uint32_t cornerAO, int sizeU = 1, int sizeV = 1) {
+    const uint32_t firstVertex = static_cast<uint32_t>(builder.vertices.size());
+    const glm::ivec3 size = toChunkCoords(face / 2, 1, sizeU, sizeV);
+
+    for (int corner = 0; corner < 4; corner++) {
+        builder.vertices.push_back(VoxelVertex::pack(
+            x + FACE_CORNERS[face][corner][0] * size.x,
+            y + FACE_CORNERS[face][corner][1] * size.y,
+            z + FACE_CORNERS[face][corner][2] * size.z,
+            static_cast<Face>(face),
+            type,
+            getCornerAO(cornerAO, corner)));
+    }
+
+    std::vector<uint32_t>& indices = isTranslucent(type) ? builder.translucentIndices : builder.indices;
+    for (uint32_t index : QUAD_INDICES[isQuadFlipped(cornerAO)]) {
+        indices.push_back(firstVertex + index);
+    }
+}
+
+// face.vert picks the diagonal from the corner AO itself
+void appendQuad(FaceMesh::Builder& builder, int x, int y, int z, int face, BlockType type, uint32_t cornerAO, int sizeU = 1, int sizeV = 1) {
+    std::vector<VoxelFace>& faces = isTranslucent(type) ? builder.translucentFaces : builder.faces;
+    faces.push_back(VoxelFace::pack(x, y, z, static_cast<Face>(face), sizeU, sizeV, type, cornerAO));
+}
+
+// What a builder holds so far, in the vertices and indices the GPU ends up drawing
+MeshStats getBuilderSize(const Model::Builder& builder) {
+    MeshStats size{};
+    size.vertexCount = static_cast<uint32_t>(builder.vertices.size());
+    size.indexCount = static_cast<uint32_t>(builder.indices.size());
+    size.quadCount = size.vertexCount / 4;
+    return size;
+}
+
+MeshStats getBuilderSize(const VoxelMesh::Builder& builder) {
+    MeshStats size{};
+    size.vertexCount = static_cast<uint32_t>(builder.vertices.size());
+    size.indexCount = static_cast<uint32_t>(builder.indices.size() + builder.translucentIndices.size());
+    size.quadCount = size.vertexCount / 4;
+    return size;
+}
+
+MeshStats getBuilderSize(const FaceMesh::Builder& builder) {
+    MeshStats size{};
+    size.quadCount = static_cast<uint32_t>(builder.faces.size() + builder.translucentFaces.size());
+    size.vertexCount = size.quadCount * 4;
+    size.indexCount = size.quadCount * 6;
+    return size;
+}
+
+// Box of blocks [min, max) whose faces a meshing pass emits. Quads never cross its bounds,
+// so the meshes of disjoint regions can be rebuilt independently and concatenated.
+struct MeshRegion {
+    glm::ivec3 min{0, 0, 0};
+    glm::ivec3 max{static_cast<int>(Chunk::LENGTH), static_cast<int>(Chunk::LENGTH), static_cast<int>(Chunk::LENGTH)};
+};
+
+MeshRegion getSectionRegion(size_t section) {
+    const int sectionLength = static_cast<int>(Chunk::SECTION_LENGTH);
+    const int sectionsPerAxis = static_cast<int>(Chunk::SECTIONS_PER_AXIS);
+    const int index = static_cast<int>(section);
+    MeshRegion region{};
+    region.min = glm::ivec3{
+        index % sectionsPerAxis,
+        (index / sectionsPerAxis) % sectionsPerAxis,
+        index / (sectionsPerAxis * sectionsPerAxis),
+    } * sectionLength;
+    region.max = region.min + sectionLength;
+    return region;
+}
+
+// In-plane axes (u, v) of faces along axis, as for the column masks
+int getUAxis(int axis) { return axis == AXIS_X ? AXIS_Y : AXIS_X; }
+int getVAxis(int axis) { return axis == AXIS_Z ? AXIS_Y : AXIS_Z; }
+
+// Classic vertex AO of the 4 corners of a block face, from the 8 blocks around the block in
+// front of it: per corner the two blocks along its edges and the one diagonal to it. With
+// both edge blocks opaque the corner is fully occluded whatever the diagonal.
+// The 8 blocks are gathered into a ring mask, bit (du + 1) + 3 * (dv + 1) for the block at
+// (du, dv) along the face's (u, v) axes, and the levels come from a table per face.
+struct FaceAOTable {
+    uint8_t cornerAO[NUMBER_OF_FACES][512];
+};
+
+FaceAOTable buildFaceAOTable() {
+    FaceAOTable table{};
+    for (int face = 0; face < NUMBER_OF_FACES; face++) {
+        const int axis = face / 2;
+        for (uint32_t ring = 0; ring < 512; ring++) {
+            auto opaqueAt = [ring](int du, int dv) { return (ring >> ((du + 1) + 3 * (dv + 1))) & 1u; };
+            uint32_t cornerAO = 0;
+            for (int corner = 0; corner < 4; corner++) {
+                const int du = FACE_CORNERS[face][corner][getUAxis(axis)] ? 1 : -1;
+                const int dv = FACE_CORNERS[face][corner][getVAxis(axis)] ? 1 : -1;
+                const uint32_t sideU = opaqueAt(du, 0);
+                const uint32_t sideV = opaqueAt(0, dv);
+                const uint32_t level = sideU && sideV ? 3u : sideU + sideV + opaqueAt(du, dv);
+                cornerAO |= level << (2 * corner);
+            }
+            table.cornerAO[face][ring] = static_cast<uint8_t>(cornerAO);
+        }
+    }
+    return table;
+}
+
+const FaceAOTable FACE_AO_TABLE = buildFaceAOTable();
+
+// (d, u, v) is the block in front of the face, in the layer coordinates of the face axis;
+// opaqueColumns are the chunk's opaque column masks along that axis
+uint32_t getFaceAO(const ChunkNeighborhood& neighborhood, const uint32_t* opaqueColumns, int face, int d, int u, int v) {
+    const int length = static_cast<int>(Chunk::LENGTH);
+    uint32_t ring = 0;
+    if (d >= 0 && d < length && u > 0 && u < length - 1 && v > 0 && v < length - 1) {
+        for (int dv = -1; dv <= 1; dv++) {
+            for (int du = -1; du <= 1; du++) {
+                ring |= ((opaqueColumns[Chunk::getColumnIndex(u + du, v + dv)] >> d) & 1u) << ((du + 1) + 3 * (dv + 1));
+            }
+        }
+    } else {
+        // Next to the chunk bounds: only the blocks outside go through the neighborhood
+        const bool layerInside = d >= 0 && d < length;
+        for (int dv = -1; dv <= 1; dv++) {
+            for (int du = -1; du <= 1; du++) {
+                const int ringU = u + du;
+                const int ringV = v + dv;
+                bool opaque;
+                if (layerInside && ringU >= 0 && ringU < length && ringV >= 0 && ringV < length) {
+                    opaque = (opaqueColumns[Chunk::getColumnIndex(ringU, ringV)] >> d) & 1u;
+                } else {
+                    const glm::ivec3 position = toChunkCoords(face / 2, d, ringU, ringV);
+                    opaque = neighborhood.isOpaqueAt(position.x, position.y, position.z);
+                }
+                ring |= static_cast<uint32_t>(opaque) << ((du + 1) + 3 * (dv + 1));
+            }
+        }
+    }
+    return FACE_AO_TABLE.cornerAO[face][ring];
+}
+
+uint32_t getFaceAO(const ChunkNeighborhood& neighborhood, const uint32_t* opaqueColumns, glm::ivec3 block, int face) {
+    const int axis = face / 2;
+    const int d = block[axis] + (face % 2 == 0 ? -1 : 1);
+    return getFaceAO(neighborhood, opaqueColumns, face, d, block[getUAxis(axis)], block[getVAxis(axis)]);
+}
+
+// Same as getFaceAO, given the opacity masks of the layer in front at rows v - 1, v and v + 1
+// with bit u + 1 for the block at u in [-1, LENGTH]
+uint32_t getFaceAO(const uint64_t frontRows[3], int face, int u) {
+    const uint32_t ring = static_cast<uint32_t>((frontRows[0] >> u) & 7u)
+        | static_cast<uint32_t>(((frontRows[1] >> u) & 7u) << 3)
+        | static_cast<uint32_t>(((frontRows[2] >> u) & 7u) << 6);
+    return FACE_AO_TABLE.cornerAO[face][ring];
+}
+
+// Opacity of the blocks at i in [-1, LENGTH] along rowAxis, bit i + 1, of the row through
+// (a, b) on the column mask axes of rowAxis, both in [-1, LENGTH]. Rows inside the chunk take
+// their ends from the border slices; only rows outside it go block by block.
+uint64_t getPaddedOpacityRow(const ChunkNeighborhood& neighborhood, int rowAxis, int a, int b) {
+    const int length = static_cast<int>(Chunk::LENGTH);
+    if (a >= 0 && a < length && b >= 0 && b < length) {
+        const size_t column = Chunk::getColumnIndex(a, b);
+        return (static_cast<uint64_t>(neighborhood.chunk->getOpaqueColumns(static_cast<Axis>(rowAxis))[column]) << 1)
+            | static_cast<uint64_t>(isOpaque(neighborhood.borders[rowAxis * 2][column]))
+            | (static_cast<uint64_t>(isOpaque(neighborhood.borders[rowAxis * 2 + 1][column])) << (length + 1));
+    }
+    uint64_t row = 0;
+    for (int i = -1; i <= length; i++) {
+        const glm::ivec3 position = toChunkCoords(rowAxis, i, a, b);
+        row |= static_cast<uint64_t>(neighborhood.isOpaqueAt(position.x, position.y, position.z)) << (i + 1);
+    }
+    return row;
+}
+
+// Bit d is set where blocks d and d + 1 of a column are the same translucent type, the
+// faces between them being hidden. translucent is the column's solid & ~opaque mask.
+uint32_t getTranslucentPairs(const Chunk& chunk, int axis, int u, int v, uint32_t translucent) {
+    uint32_t pairs = 0;
+    for (uint32_t bits = translucent & (translucent >> 1); bits != 0; bits &= bits - 1) {
+        const int d = countTrailingZeros(bits);
+        const glm::ivec3 block = toChunkCoords(axis, d, u, v);
+        const glm::ivec3 next = toChunkCoords(axis, d + 1, u, v);
+        if (chunk.getBlockUnchecked(block.x, block.y, block.z) == chunk.getBlockUnchecked(next.x, next.y, next.z)) {
+            pairs |= 1u << d;
+        }
+    }
+    return pairs;
+}
+
+// The meshing passes below are templated on the builder and emit through appendQuad
+
+// A uniform opaque chunk hides all of its interior faces, so only the outer layer is visited
+template <typename MeshBuilder>
+void appendUniformBorderFaces(const ChunkNeighborhood& neighborhood, MeshBuilder& builder, BlockType type, const MeshRegion& region) {
+    const int last = static_cast<int>(Chunk::LENGTH) - 1;
+    for (int face = 0; face < NUMBER_OF_FACES; face++) {
+        const int axis = face / 2;
+        const int layer = face % 2 == 0 ? 0 : last;
+        if (layer < region.min[axis] || layer >= region.max[axis]) continue;
+
+        const int uAxis = getUAxis(axis);
+        const int vAxis = getVAxis(axis);
+        const uint32_t* opaque = neighborhood.chunk->getOpaqueColumns(static_cast<Axis>(axis));
+        for (int v = region.min[vAxis]; v < region.max[vAxis]; v++) {
+            for (int u = region.min[uAxis]; u < region.max[uAxis]; u++) {
+                if (isOpaque(neighborhood.borders[face][Chunk::getColumnIndex(u, v)])) continue;
+                const glm::ivec3 block = toChunkCoords(axis, layer, u, v);
+                appendQuad(builder, block.x, block.y, block.z, face, type, getFaceAO(neighborhood, opaque, block, face));
+            }
+        }
+    }
+}
+
+template <typename MeshBuilder>
+void buildCulledMesh(const ChunkNeighborhood& neighborhood, MeshBuilder& builder, const MeshRegion& region) {
+    const Chunk& chunk = *neighborhood.chunk;
+    const uint32_t* opaque[3] = {
+        chunk.getOpaqueColumns(AXIS_X), chunk.getOpaqueColumns(AXIS_Y), chunk.getOpaqueColumns(AXIS_Z),
+    };
+    for (int z = region.min.z; z < region.max.z; z++) {
+        for (int y = region.min.y; y < region.max.y; y++) {
+            for (int x = region.min.x; x < region.max.x; x++) {
+                const BlockType type = chunk.getBlockUnchecked(x, y, z);
+                if (!isSolid(type)) continue;
+
+                for (int face = 0; face < NUMBER_OF_FACES; face++) {
+                    const BlockType neighbor = neighborhood.getBlock(
+                        x + FACE_DIRECTIONS[face][0],
+                        y + FACE_DIRECTIONS[face][1],
+                        z + FACE_DIRECTIONS[face][2]);
+                    if (!isFaceVisible(type, neighbor)) continue;
+                    appendQuad(builder, x, y, z, face, type, getFaceAO(neighborhood, opaque[face / 2], {x, y, z}, face));
+                }
+            }
+        }
+    }
+}
+
+// Block type in the low byte, corner AO in the high byte; faces only merge when both match
+uint32_t getFaceKey(BlockType type, uint32_t cornerAO) { return static_cast<uint32_t>(type) | (cornerAO << 8); }
+
+// Per face direction and layer, collects the visible faces into a 2D mask and repeatedly
+// takes the first set cell, grows it along u and then v while the block type and corner AO
+// match, and emits the rectangle as one quad.
+template <typename MeshBuilder>
+void buildGreedyMesh(const ChunkNeighborhood& neighborhood, MeshBuilder& builder, const MeshRegion& region) {
+    const Chunk& chunk = *neighborhood.chunk;
+    std::array<uint16_t, Chunk::COLUMNS> mask; // getFaceKey, 0 where no face is visible
+
+    for (int face = 0; face < NUMBER_OF_FACES; face++) {
+        const int axis = face / 2;
+        const int uAxis = getUAxis(axis);
+        const int vAxis = getVAxis(axis);
+        const int uMin = region.min[uAxis];
+        const int uMax = region.max[uAxis];
+        const int vMin = region.min[vAxis];
+        const int vMax = region.max[vAxis];
+        const glm::ivec3 direction{FACE_DIRECTIONS[face][0], FACE_DIRECTIONS[face][1], FACE_DIRECTIONS[face][2]};
+        const uint32_t* opaque = chunk.getOpaqueColumns(static_cast<Axis>(axis));
+
+        for (int d = region.min[axis]; d < region.max[axis]; d++) {
+            for (int v = vMin; v < vMax; v++) {
+                for (int u = uMin; u < uMax; u++) {
+                    const glm::ivec3 block = toChunkCoords(axis, d, u, v);
+                    const BlockType type = chunk.getBlockUnchecked(block.x, block.y, block.z);
+                    const glm::ivec3 next = block + direction;
+                    const bool visible = isFaceVisible(type, neighborhood.getBlock(next.x, next.y, next.z));
+                    mask[Chunk::getColumnIndex(u, v)] = visible
+                        ? static_cast<uint16_t>(getFaceKey(type, getFaceAO(neighborhood, opaque, block, face))) : 0;
+                }
+            }
+
+            for (int v = vMin; v < vMax; v++) {
+                for (int u = uMin; u < uMax;) {
+                    const uint16_t key = mask[Chunk::getColumnIndex(u, v)];
+                    if (key == 0) {
+                        u++;
+                        continue;
+                    }
+
+                    int width = 1;
+                    while (u + width < uMax && mask[Chunk::getColumnIndex(u + width, v)] == key) {
+                        width++;
+                    }
+
+                    int height = 1;
+                    for (; v + height < vMax; height++) {
+                        bool rowMatches = true;
+                        for (int k = 0; k < width && rowMatches; k++) {
+                            rowMatches = mask[Chunk::getColumnIndex(u + k, v + height)] == key;
+                        }
+                        if (!rowMatches) break;
+                    }
+
+                    for (int h = 0; h < height; h++) {
+                        for (int k = 0; k < width; k++) {
+                            mask[Chunk::getColumnIndex(u + k, v + h)] = 0;
+                        }
+                    }
+
+                    const glm::ivec3 block = toChunkCoords(axis, d, u, v);
+                    appendQuad(builder, block.x, block.y, block.z, face, static_cast<BlockType>(key & 0xff), key >> 8, width, height);
+                    u += width;
+                }
+            }
+        }
+    }
+}
+
+// Greedy meshing on bit planes. For every column along an axis, the faces visible towards
+// -axis are solid & ~(opaque << 1) and towards +axis solid & ~(opaque >> 1), with the border
+// slice supplying the bit shifted in from the neighbor. Columns holding translucent blocks
+// also cover the faces between two blocks of the same type. The visible bits are then scattered
+// into one 32x32 plane per layer (bit u of row v), and rectangles are grown from the lowest
+// set bit with count-trailing-zeros. Block types and AO are only looked up for visible faces.
+template <typename MeshBuilder>
+void buildBinaryMesh(const ChunkNeighborhood& neighborhood, MeshBuilder& builder, const MeshRegion& region) {
+    const Chunk& chunk = *neighborhood.chunk;
+    const int length = static_cast<int>(Chunk::LENGTH);
+    std::array<uint32_t, Chunk::LENGTH * Chunk::LENGTH> planes; // [layer * LENGTH + v], bit u
+    std::array<uint32_t, Chunk::COLUMNS> keys; // getFaceKey of the visible faces of one layer, by getColumnIndex(u, v)
+    // getPaddedOpacityRow along u of the rows in front of the faces of one axis, by
+    // (front + 1) * PADDED + row + 1; gathered on first use, as both directions share them
+    constexpr int PADDED = static_cast<int>(Chunk::LENGTH) + 2;
+    constexpr uint64_t UNGATHERED = ~0ull;
+    std::array<uint64_t, PADDED * PADDED> paddedRows;
+    std::array<uint32_t, Chunk::COLUMNS> pairs; // getTranslucentPairs of the columns along one axis
+    // With at most one translucent type in the palette, neighboring translucent blocks always match
+    size_t translucentTypes = 0;
+    for (size_t i = 0; i < chunk.getPaletteSize(); i++) {
+        translucentTypes += isTranslucent(chunk.getPaletteEntry(i)) ? 1 : 0;
+    }
+    auto bitRange = [](int first, int end) {
+        const uint32_t upTo = end >= 32 ? ~0u : (1u << end) - 1u;
+        return upTo & ~((1u << first) - 1u);
+    };
+
+    for (int axis = AXIS_X; axis <= AXIS_Z; axis++) {
+        const uint32_t* solid = chunk.getSolidColumns(static_cast<Axis>(axis));
+        const uint32_t* opaque = chunk.getOpaqueColumns(static_cast<Axis>(axis));
+        const int uAxis = getUAxis(axis);
+        // The rows along u are indexed by (front layer, row) on the column mask axes of u,
+        // except for faces along z, where it is (row, front layer)
+        paddedRows.fill(UNGATHERED);
+        auto frontRow = [&](int front, int row) {
+            uint64_t& mask = paddedRows[(front + 1) * PADDED + row + 1];
+            if (mask == UNGATHERED) {
+                mask = axis == AXIS_Z ? getPaddedOpacityRow(neighborhood, uAxis, row, front)
+                                      : getPaddedOpacityRow(neighborhood, uAxis, front, row);
+            }
+            return mask;
+        };
+        const int vAxis = getVAxis(axis);
+        const int uMin = region.min[uAxis];
+        const int uMax = region.max[uAxis];
+        const int vMin = region.min[vAxis];
+        const int vMax = region.max[vAxis];
+        const int dMin = region.min[axis];
+        const int dMax = region.max[axis];
+        const uint32_t layers = bitRange(dMin, dMax);
+
+        for (int v = vMin; v < vMax; v++) {
+            for (int u = uMin; u < uMax; u++) {
+                const size_t column = Chunk::getColumnIndex(u, v);
+                const uint32_t translucent = solid[column] & ~opaque[column];
+                pairs[column] = translucent == 0 ? 0u
+                    : translucentTypes <= 1 ? translucent & (translucent >> 1) : getTranslucentPairs(chunk, axis, u, v, translucent);
+            }
+        }
+
+        for (int direction = 0; direction < 2; direction++) {
+            const int face = axis * 2 + direction;
+            const ChunkNeighborhood::Slice& border = neighborhood.borders[face];
+
+            for (int d = dMin; d < dMax; d++) {
+                std::fill(planes.begin() + d * length + vMin, planes.begin() + d * length + vMax, 0u);
+            }
+            bool anyVisible = false;
+            for (int v = vMin; v < vMax; v++) {
+                for (int u = uMin; u < uMax; u++) {
+                    const size_t column = Chunk::getColumnIndex(u, v);
+                    const BlockType borderType = border[column];
+                    uint32_t borderBit = isOpaque(borderType) ? 1u : 0u;
+                    if (isTranslucent(borderType) && (solid[column] & ~opaque[column]) != 0) {
+                        const glm::ivec3 edge = toChunkCoords(axis, direction == 0 ? 0 : length - 1, u, v);
+                        borderBit = chunk.getBlockUnchecked(edge.x, edge.y, edge.z) == borderType ? 1u : 0u;
+                    }
+                    const uint32_t covered = direction == 0
+                        ? (opaque[column] << 1) | (pairs[column] << 1) | borderBit
+                        : (opaque[column] >> 1) | pairs[column] | (borderBit << 31);
+
+                    uint32_t visible = solid[column] & ~covered & layers;
+                    anyVisible |= visible != 0;
+                    while (visible != 0) {
+                        const int d = countTrailingZeros(visible);
+                        planes[d * length + v] |= 1u << u;
+                        visible &= visible - 1;
+                    }
+                }
+            }
+            if (!anyVisible) continue;
+
+            for (int d = dMin; d < dMax; d++) {
+                uint32_t* plane = planes.data() + d * length;
+                const int front = direction == 0 ? d - 1 : d + 1;
+                if (std::all_of(plane + vMin, plane + vMax, [](uint32_t row) { return row == 0; })) continue;
+
+                for (int v = vMin; v < vMax; v++) {
+                    if (plane[v] == 0) continue;
+
+                    // Three row masks serve all faces of the row
+                    const uint64_t frontRows[3] = {frontRow(front, v - 1), frontRow(front, v), frontRow(front, v + 1)};
+
+                    for (uint32_t bits = plane[v]; bits != 0; bits &= bits - 1) {
+                        const int u = countTrailingZeros(bits);
+                        const glm::ivec3 block = toChunkCoords(axis, d, u, v);
+                        const BlockType type = chunk.getBlockUnchecked(block.x, block.y, block.z);
+                        keys[Chunk::getColumnIndex(u, v)] = getFaceKey(type, getFaceAO(frontRows, face, u));
+                    }
+                }
+
+                for (int v = vMin; v < vMax; v++) {
+                    while (plane[v] != 0) {
+                        const int u = countTrailingZeros(plane[v]);
+                        const uint32_t key = keys[Chunk::getColumnIndex(u, v)];
+
+                        // Longest run of set bits starting at u (bits outside the region are
+                        // never set), then cut where the type or AO changes
+                        const uint32_t unset = ~(plane[v] >> u);
+                        const int run = unset == 0 ? length - u : countTrailingZeros(unset);
+                        int width = 1;
+                        while (width < run && keys[Chunk::getColumnIndex(u + width, v)] == key) {
+                            width++;
+                        }
+                        const uint32_t rowBits = (width == 32 ? ~0u : ((1u << width) - 1u)) << u;
+
+                        int height = 1;
+                        while (v + height < vMax && (plane[v + height] & rowBits) == rowBits) {
+                            bool sameKey = true;
+                            for (int k = 0; k < width && sameKey; k++) {
+                                sameKey = keys[Chunk::getColumnIndex(u + k, v + height)] == key;
+                            }
+                            if (!sameKey) break;
+                            plane[v + height] &= ~rowBits;
+                            height++;
+                        }
+                        plane[v] &= ~rowBits;
+
+                        const glm::ivec3 block = toChunkCoords(axis, d, u, v);
+                        appendQuad(builder, block.x, block.y, block.z, face, static_cast<BlockType>(key & 0xff), key >> 8, width, height);
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename MeshBuilder>
+MeshStats buildMeshWith(const ChunkNeighborhood& neighborhood, MeshBuilder& builder, MeshingMode mode, const MeshRegion& region) {
+    const MeshStats before = getBuilderSize(builder);
+
+    const Chunk& chunk = *neighborhood.chunk;
+    if (chunk.isEmpty()) return {};
+
+    if (mode == MESHING_BINARY) {
+        buildBinaryMesh(neighborhood, builder, region);
+    } else if (mode == MESHING_GREEDY) {
+        buildGreedyMesh(neighborhood, builder, region);
+    } else if (chunk.isUniform() && isOpaque(chunk.getBlockUnchecked(0, 0, 0))) {
+        appendUniformBorderFaces(neighborhood, builder, chunk.getBlockUnchecked(0, 0, 0), region);
+    } else {
+        buildCulledMesh(neighborhood, builder, region);
+    }
+
+    MeshStats stats = getBuilderSize(builder);
+    stats.quadCount -= before.quadCount;
+    stats.vertexCount -= before.vertexCount;
+    stats.indexCount -= before.indexCount;
+    return stats;
+}
+
+// The cells, shell included, are copied into a scratch chunk and its inner cells meshed as a
+// region, so the shell hides and shades the faces at the chunk bounds like neighbor blocks do
+template <typename MeshBuilder>
+MeshStats buildLodMeshWith(const LodNeighborhood& lod, MeshBuilder& builder, MeshingMode mode) {
+    const int size = lod.getSize();
+    assert(size <= static_cast<int>(Chunk::LENGTH) && "LOD grid must fit a chunk");
+
+    Chunk grid{};
+    std::array<BlockType, Chunk::LENGTH> row;
+    row.fill(AIR);
+    for (int z = 0; z < size; z++) {
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                row[x] = lod.getCell(x, y, z);
+            }
+            grid.setRow(y, z, row.data());
+        }
+    }
+
+    MeshRegion region{};
+    region.min = glm::ivec3{1, 1, 1};
+    region.max = glm::ivec3{size - 1, size - 1, size - 1};
+    return buildMeshWith(ChunkNeighborhood::gather(grid, ChunkNeighborhood::Neighbors{}), builder, mode, region);
+}
+
+// xxHash64-style rounds over 8-byte words and a splitmix64 finish: fast, well mixed, and not
+// meant to resist deliberate collisions
+class ContentHasher {
+public:
+    void add(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (; size >= sizeof(uint64_t); bytes += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, bytes, sizeof(word));
+            mix(word);
+        }
+        if (size > 0) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes, size);
+            mix(word ^ (static_cast<uint64_t>(size) << 56));
+        }
+    }
+
+    uint64_t finish() const {
+        uint64_t hash = state;
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+        return hash ^ (hash >> 31);
+    }
+
+private:
+    void mix(uint64_t word) {
+        state += word * 0xc2b2ae3d27d4eb4full;
+        state = (state << 31) | (state >> 33);
+        state *= 0x9e3779b185ebca87ull;
+    }
+
+    uint64_t state = 0x27d4eb2f165667c5ull;
+};
+
+} // namespace
+
+ChunkNeighborhood ChunkNeighborhood::gather(const Chunk& chunk, const Neighbors& neighbors) {
+    const int length = static_cast<int>(Chunk::LENGTH);
+    ChunkNeighborhood neighborhood{};
+    neighborhood.chunk = &chunk;
+
+    for (int face = 0; face < NUMBER_OF_FACES; face++) {
+        Slice& slice = neighborhood.borders[face];
+        const Chunk* neighbor = neighbors[Chunk::getNeighborIndex(FACE_DIRECTIONS[face][0], FACE_DIRECTIONS[face][1], FACE_DIRECTIONS[face][2])];
+        if (neighbor == nullptr) {
+            slice.fill(AIR);
+            continue;
+        }
+
+        // The layer of the neighbor that touches this chunk
+        const int layer = face % 2 == 0 ? length - 1 : 0;
+        for (int v = 0; v < length; v++) {
+            BlockType* out = slice.data() + Chunk::getColumnIndex(0, v);
+            switch (face / 2) {
+                case AXIS_X: neighbor->getColumn(layer, v, out); break;
+                case AXIS_Y: neighbor->getRow(layer, v, out); break;
+                default:     neighbor->getRow(v, layer, out); break;
+            }
+        }
+    }
+
+    // An edge is one opaque column of the chunk diagonal to it, taken from the side facing us
+    for (int axis = AXIS_X; axis <= AXIS_Z; axis++) {
+        const int uAxis = getUAxis(axis);
+        const int vAxis = getVAxis(axis);
+        for (int side = 0; side < 4; side++) {
+            const int su = side & 1;
+            const int sv = side >> 1;
+            glm::ivec3 offset{0};
+            offset[uAxis] = su ? 1 : -1;
+            offset[vAxis] = sv ? 1 : -1;
+            const Chunk* neighbor = neighbors[Chunk::getNeighborIndex(offset.x, offset.y, offset.z)];
+            if (neighbor == nullptr) continue;
+            neighborhood.edgeOpacity[axis * 4 + side] =
+                neighbor->getOpaqueColumn(static_cast<Axis>(axis), su ? 0 : length - 1, sv ? 0 : length - 1);
+        }
+    }
+
+    for (int corner = 0; corner < 8; corner++) {
+        const int sx = corner & 1;
+        const int sy = (corner >> 1) & 1;
+        const int sz = corner >> 2;
+        const Chunk* neighbor = neighbors[Chunk::getNeighborIndex(sx ? 1 : -1, sy ? 1 : -1, sz ? 1 : -1)];
+        if (neighbor == nullptr) continue;
+        if (isOpaque(neighbor->getBlock(sx ? 0 : length - 1, sy ? 0 : length - 1, sz ? 0 : length - 1))) {
+            neighborhood.cornerOpacity |= static_cast<uint8_t>(1u << corner);
+        }
+    }
+    return neighborhood;
+}
+
+uint64_t ChunkNeighborhood::getContentHash(MeshingMode mode) const {
+    const int length = static_cast<int>(Chunk::LENGTH);
+    ContentHasher hasher{};
+    std::array<BlockType, Chunk::LENGTH> row;
+    for (int z = 0; z < length; z++) {
+        for (int y = 0; y < length; y++) {
+            chunk->getRow(y, z, row.data());
+            hasher.add(row.data(), sizeof(row));
+        }
+    }
+    hasher.add(borders.data(), sizeof(borders));
+    hasher.add(edgeOpacity.data(), sizeof(edgeOpacity));
+    hasher.add(&cornerOpacity, sizeof(cornerOpacity));
+    hasher.add(&mode, sizeof(mode));
+    return hasher.finish();
+}
+
+MeshStats ChunkMesher::buildMesh(const ChunkNeighborhood& neighborhood, FaceMesh::Builder& builder, MeshingMode mode) {
+    return buildMeshWith(neighborhood, builder, mode, MeshRegion{});
+}
+
+MeshStats ChunkMesher::buildMesh(const ChunkNeighborhood& neighborhood, VoxelMesh::Builder& builder, MeshingMode mode) {
+    return buildMeshWith(neighborhood, builder, mode, MeshRegion{});
+}
+
+MeshStats ChunkMesher::buildMesh(const ChunkNeighborhood& neighborhood, Model::Builder& builder, MeshingMode mode) {
+    return buildMeshWith(neighborhood, builder, mode, MeshRegion{});
+}
+
+MeshStats ChunkMesher::buildSectionMesh(const ChunkNeighborhood& neighborhood, FaceMesh::Builder& builder, size_t section, MeshingMode mode) {
+    assert(section < Chunk::SECTION_COUNT && "buildSectionMesh section out of range");
+    return buildMeshWith(neighborhood, builder, mode, getSectionRegion(section));
+}
+
+MeshStats ChunkMesher::buildSectionMesh(const ChunkNeighborhood& neighborhood, VoxelMesh::Builder& builder, size_t section, MeshingMode mode) {
+    assert(section < Chunk::SECTION_COUNT && "buildSectionMesh section out of range");
+    return buildMeshWith(neighborhood, builder, mode, getSectionRegion(section));
+}
+
+MeshStats ChunkMesher::buildLodMesh(const LodNeighborhood& neighborhood, FaceMesh::Builder& builder, MeshingMode mode) {
+    return buildLodMeshWith(neighborhood, builder, mode);
+}
+
+MeshStats ChunkMesher::buildLodMesh(const LodNeighborhood& neighborhood, VoxelMesh::Builder& builder, MeshingMode mode) {
+    return buildLodMeshWith(neighborhood, builder, mode);
+}
+
+void ChunkMeshSections::assemble(FaceMesh::Builder& builder) const {
+    size_t faceCount = builder.faces.size();
+    size_t translucentFaceCount = builder.translucentFaces.size();
+    for (const FaceMesh::Builder& section : faces) {
+        faceCount += section.faces.size();
+        translucentFaceCount += section.translucentFaces.size();
+    }
+    builder.faces.reserve(faceCount);
+    builder.translucentFaces.reserve(translucentFaceCount);
+    for (const FaceMesh::Builder& section : faces) {
+        builder.faces.insert(builder.faces.end(), section.faces.begin(), section.faces.end());
+        builder.translucentFaces.insert(builder.translucentFaces.end(), section.translucentFaces.begin(), section.translucentFaces.end());
+    }
+}
+
+void ChunkMeshSections::assemble(VoxelMesh::Builder& builder) const {
+    for (const VoxelMesh::Builder& section : vertices) {
+        const uint32_t firstVertex = static_cast<uint32_t>(builder.vertices.size());
+        builder.vertices.insert(builder.vertices.end(), section.vertices.begin(), section.vertices.end());
+        for (uint32_t index : section.indices) {
+            builder.indices.push_back(firstVertex + index);
+        }
+        for (uint32_t index : section.translucentIndices) {
+            builder.translucentIndices.push_back(firstVertex + index);
+        }
+    }
+}
+
+// Quads are ordered by the distance from the view to their center, farthest first. Quads of
+// one chunk never intersect, so this is exact for all but long quads seen at grazing angles.
+void ChunkMesher::sortTranslucentFaces(FaceMesh::Builder& builder, glm::vec3 viewPosition) {
+    std::vector<std::pair<float, VoxelFace>> order;
+    order.reserve(builder.translucentFaces.size());
+    for (const VoxelFace& record : builder.translucentFaces) {
+        const int axis = record.getFace() / 2;
+        glm::vec3 center(record.getX(), record.getY(), record.getZ());
+        center += glm::vec3(toChunkCoords(axis, 0, record.getSizeU(), record.getSizeV())) * 0.5f;
+        center[axis] += record.getFace() % 2 == 0 ? 0.f : 1.f;
+        const glm::vec3 offset = center - viewPosition;
+        order.emplace_back(glm::dot(offset, offset), record);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = 0; i < order.size(); i++) {
+        builder.translucentFaces[i] = order[i].second;
+    }
+}
+
+// Each quad is 6 indices whose first and third vertex are opposite corners (see QUAD_INDICES)
+void ChunkMesher::sortTranslucentFaces(VoxelMesh::Builder& builder, glm::vec3 viewPosition) {
+    auto position = [&builder](uint32_t index) {
+        const VoxelVertex vertex = builder.vertices[index];
+        return glm::vec3(vertex.getX(), vertex.getY(), vertex.getZ());
+    };
+    const size_t quadCount = builder.translucentIndices.size() / 6;
+    std::vector<std::pair<float, uint32_t>> order; // distance, first index of the quad
+    order.reserve(quadCount);
+    for (size_t quad = 0; quad < quadCount; quad++) {
+        const uint32_t* indices = builder.translucentIndices.data() + quad * 6;
+        const glm::vec3 offset = (position(indices[0]) + position(indices[2])) * 0.5f - viewPosition;
+        order.emplace_back(glm::dot(offset, offset), static_cast<uint32_t>(quad * 6));
+    }
+    std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(builder.translucentIndices.size());
+    for (const auto& entry : order) {
+        sorted.insert(sorted.end(), builder.translucentIndices.begin() + entry.second, builder.translucentIndices.begin() + entry.second + 6);
+    }
+    builder.translucentIndices.swap(sorted);
+}
+
+glm::vec3 ChunkMesher::getBlockColor(BlockType type) {
+    switch (type) {
+        case DIRT:   return {0.45f, 0.31f, 0.18f};
+        case GRASS:  return {0.33f, 0.60f, 0.22f};
+        case STONE:  return {0.50f, 0.50f, 0.52f};
+        case WATER:  return {0.16f, 0.36f, 0.70f};
+        case GLASS:  return {0.78f, 0.88f, 0.92f};
+        case LOG:    return {0.40f, 0.27f, 0.14f};
+        case LEAVES: return {0.20f, 0.45f, 0.15f};
+        default:     return {1.f, 0.f, 1.f};
+    }
+}
+
+} // namespace engine
@@ -0,0 +1,80 @@
+#include <chunk_streamer.hpp>
+#include <chunk.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace engine {
+
+namespace {
+
+glm::vec3 getChunkCenter(glm::ivec3 chunkCoord) {
+    return (glm::vec3(chunkCoord) + glm::vec3(0.5f)) * static_cast<float>(CHUNK_LENGTH);
+}
+
+// The most urgent maxCount of candidates, in order
+std::vector<glm::ivec3> takeFirst(std::vector<std::pair<float, glm::ivec3>>& candidates, size_t maxCount) {
+    const size_t count = std::min(maxCount, candidates.size());
+    const auto byKey = [](const auto& a, const auto& b) { return a.first < b.first; };
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), byKey);
+    std::vector<glm::ivec3> chunks;
+    chunks.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        chunks.push_back(candidates[i].second);
+    }
+    return chunks;
+}
+
+} // namespace
+
+float ChunkStreamer::getDistance(const View& view, glm::ivec3 chunkCoord) const {
+    const glm::vec3 center = getChunkCenter(chunkCoord);
+    const float distance = std::min(glm::distance(center, view.position), glm::distance(center, getPrefetchPosition(view)));
+    return distance / static_cast<float>(CHUNK_LENGTH);
+}
+
+float ChunkStreamer::getPriority(const View& view, glm::ivec3 chunkCoord) const {
+    const glm::vec3 offset = getChunkCenter(chunkCoord) - getPrefetchPosition(view);
+    const float distance = glm::length(offset);
+    if (distance <= 0.f) return 0.f;
+    const float facing = std::max(glm::dot(offset / distance, view.direction), 0.f);
+    return distance * (1.f - settings.viewWeight * facing);
+}
+
+std::vector<glm::ivec3> ChunkStreamer::getMissingChunks(const View& view, const std::function<bool(glm::ivec3)>& isKnown,
+    size_t maxCount) const {
+    // The box around both the camera and its prefetch position
+    const float length = static_cast<float>(CHUNK_LENGTH);
+    const glm::vec3 prefetch = getPrefetchPosition(view);
+    const glm::vec3 low = glm::min(view.position, prefetch) / length - settings.loadRadius;
+    const glm::vec3 high = glm::max(view.position, prefetch) / length + settings.loadRadius;
+    const int minY = std::max(static_cast<int>(std::floor(low.y)), settings.minChunkY);
+    const int maxY = std::min(static_cast<int>(std::floor(high.y)), settings.maxChunkY);
+
+    std::vector<std::pair<float, glm::ivec3>> candidates;
+    for (int z = static_cast<int>(std::floor(low.z)); z <= static_cast<int>(std::floor(high.z)); z++) {
+        for (int y = minY; y <= maxY; y++) {
+            for (int x = static_cast<int>(std::floor(low.x)); x <= static_cast<int>(std::floor(high.x)); x++) {
+                const glm::ivec3 chunkCoord{x, y, z};
+                if (getDistance(view, chunkCoord) > settings.loadRadius || isKnown(chunkCoord)) continue;
+                candidates.emplace_back(getPriority(view, chunkCoord), chunkCoord);
+            }
+        }
+    }
+    return takeFirst(candidates, maxCount);
+}
+
+std::vector<glm::ivec3> ChunkStreamer::getExpiredChunks(const View& view, const std::vector<glm::ivec3>& loaded,
+    size_t maxCount) const {
+    std::vector<std::pair<float, glm::ivec3>> candidates;
+    for (const glm::ivec3& chunkCoord : loaded) {
+        const float distance = getDistance(view, chunkCoord);
+        const bool outsideWorld = chunkCoord.y < settings.minChunkY || chunkCoord.y > settings.maxChunkY;
+        if (distance <= settings.loadRadius + settings.unloadMargin && !outsideWorld) continue;
+        candidates.emplace_back(-distance, chunkCoord);
+    }
+    return takeFirst(candidates, maxCount);
+}
+
+} // namespace engine
@@ -0,0 +1,182 @@
+#include <climate_map.hpp>
+#include <chunk_random.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace engine {
+
+namespace {
+
+// Frequencies in cycles per block; the finest octave still gets four samples per cycle
+constexpr NoiseSettings CONTINENT_NOISE{NOISE_SIMPLEX, FRACTAL_FBM, 3, 1.f / 512.f};
+constexpr NoiseSettings TEMPERATURE_NOISE{NOISE_SIMPLEX, FRACTAL_FBM, 2, 1.f / 1024.f};
+constexpr NoiseSettings HUMIDITY_NOISE{NOISE_SIMPLEX, FRACTAL_FBM, 2, 1.f / 1024.f};
+
+// Indexed by Biome
+constexpr std::array<BiomeParameters, NUMBER_OF_BIOMES> BIOME_PARAMETERS{{
+    {3.f, 0.f, 0.f},    // BIOME_OCEAN
+    {3.f, 0.f, 0.15f},  // BIOME_PLAINS
+    {12.f, 0.f, 0.5f},  // BIOME_HILLS
+    {6.f, 32.f, 0.1f},  // BIOME_MOUNTAINS
+}};
+
+float smoothStep(float edge0, float edge1, float x) {
+    const float t = std::min(std::max((x - edge0) / (edge1 - edge0), 0.f), 1.f);
+    return t * t * (3.f - 2.f * t);
+}
+
+int floorDiv(int value, int divisor) {
+    return (value >= 0 ? value : value - divisor + 1) / divisor;
+}
+
+// Hills where it is cold and not too dry
+float getHilliness(float temperature, float humidity) {
+    return smoothStep(0.05f, -0.25f, temperature) * smoothStep(-0.3f, -0.1f, humidity);
+}
+
+float getMountainWeight(float continentalness) {
+    return smoothStep(0.2f, 0.4f, continentalness);
+}
+
+Biome classify(float continentalness, float temperature, float humidity) {
+    if (continentalness < -0.1f) return BIOME_OCEAN;
+    if (getMountainWeight(continentalness) > 0.5f) return BIOME_MOUNTAINS;
+    if (getHilliness(temperature, humidity) > 0.5f) return BIOME_HILLS;
+    return BIOME_PLAINS;
+}
+
+// The parameters of every biome, weighted by how strongly it applies; the weights sum to 1
+BiomeParameters blendBiomes(float continentalness, float temperature, float humidity) {
+    const float ocean = smoothStep(-0.05f, -0.15f, continentalness);
+    const float mountains = getMountainWeight(continentalness);
+    const float land = 1.f - ocean - mountains;
+    const float hilliness = getHilliness(temperature, humidity);
+    const std::array<float, NUMBER_OF_BIOMES> weights{ocean, land * (1.f - hilliness), land * hilliness, mountains};
+
+    BiomeParameters blended{};
+    for (size_t biome = 0; biome < NUMBER_OF_BIOMES; biome++) {
+        blended.hillAmplitude += weights[biome] * BIOME_PARAMETERS[biome].hillAmplitude;
+        blended.ridgeAmplitude += weights[biome] * BIOME_PARAMETERS[biome].ridgeAmplitude;
+        blended.treeChance += weights[biome] * BIOME_PARAMETERS[biome].treeChance;
+    }
+    return blended;
+}
+
+float lerp(float a, float b, float t) { return a + (b - a) * t; }
+
+} // namespace
+
+ClimateMap::ClimateMap(uint64_t seed, NoiseBackend backend, size_t capacity)
+    : continentNoise{static_cast<uint32_t>(ChunkRandom::mix(seed)), backend},
+      temperatureNoise{static_cast<uint32_t>(ChunkRandom::mix(seed + 1)), backend},
+      humidityNoise{static_cast<uint32_t>(ChunkRandom::mix(seed + 2)), backend},
+      capacity{std::max<size_t>(capacity, 1)} {}
+
+void ClimateMap::getColumns(glm::ivec2 origin, ClimateSample* out) const {
+    const int length = static_cast<int>(CHUNK_LENGTH);
+    assert(origin.x % length == 0 && origin.y % length == 0 && "ClimateMap::getColumns origin must be chunk aligned");
+    const glm::ivec2 regionCoord{floorDiv(origin.x, REGION_LENGTH), floorDiv(origin.y, REGION_LENGTH)};
+    const std::shared_ptr<const Region> region = getRegion(regionCoord);
+    const int localX = origin.x - regionCoord.x * REGION_LENGTH;
+    const int localZ = origin.y - regionCoord.y * REGION_LENGTH;
+    for (int z = 0; z < length; z++) {
+        for (int x = 0; x < length; x++) {
+            out[x + z * length] = interpolate(*region, localX + x, localZ + z);
+        }
+    }
+}
+
+ClimateSample ClimateMap::getColumn(int x, int z) const {
+    const glm::ivec2 regionCoord{floorDiv(x, REGION_LENGTH), floorDiv(z, REGION_LENGTH)};
+    return interpolate(*getRegion(regionCoord), x - regionCoord.x * REGION_LENGTH, z - regionCoord.y * REGION_LENGTH);
+}
+
+size_t ClimateMap::getCachedRegionCount() const {
+    std::lock_guard<std::mutex> lock{cacheMutex};
+    return cachedRegions.size();
+}
+
+// Built outside the lock, so threads missing different regions do not wait for each other.
+// Two threads may build the same region; the copies are identical and the first one is kept.
+std::shared_ptr<const ClimateMap::Region> ClimateMap::getRegion(glm::ivec2 regionCoord) const {
+    {
+        std::lock_guard<std::mutex> lock{cacheMutex};
+        auto cached = cachedRegions.find(regionCoord);
+        if (cached != cachedRegions.end()) {
+            recentRegions.splice(recentRegions.begin(), recentRegions, cached->second);
+            return *cached->second;
+        }
+    }
+
+    std::shared_ptr<const Region> region = buildRegion(regionCoord);
+
+    std::lock_guard<std::mutex> lock{cacheMutex};
+    auto cached = cachedRegions.find(regionCoord);
+    if (cached != cachedRegions.end()) {
+        recentRegions.splice(recentRegions.begin(), recentRegions, cached->second);
+        return *cached->second;
+    }
+    recentRegions.push_front(region);
+    cachedRegions.emplace(regionCoord, recentRegions.begin());
+    if (recentRegions.size() > capacity) {
+        cachedRegions.erase(recentRegions.back()->coord);
+        recentRegions.pop_back();
+    }
+    return region;
+}
+
+std::shared_ptr<const ClimateMap::Region> ClimateMap::buildRegion(glm::ivec2 regionCoord) const {
+    constexpr size_t count = static_cast<size_t>(POINTS * POINTS);
+    std::array<float, count> x;
+    std::array<float, count> z;
+    for (size_t i = 0; i < count; i++) {
+        const int index = static_cast<int>(i);
+        x[i] = static_cast<float>(regionCoord.x * REGION_LENGTH + index % POINTS * CELL_LENGTH);
+        z[i] = static_cast<float>(regionCoord.y * REGION_LENGTH + index / POINTS * CELL_LENGTH);
+    }
+    std::array<float, count> continentalness;
+    std::array<float, count> temperature;
+    std::array<float, count> humidity;
+    continentNoise.fill(CONTINENT_NOISE, x.data(), z.data(), continentalness.data(), count);
+    temperatureNoise.fill(TEMPERATURE_NOISE, x.data(), z.data(), temperature.data(), count);
+    humidityNoise.fill(HUMIDITY_NOISE, x.data(), z.data(), humidity.data(), count);
+
+    std::shared_ptr<Region> region = std::make_shared<Region>();
+    region->coord = regionCoord;
+    region->points.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        region->points[i] = {continentalness[i], temperature[i], humidity[i],
+            blendBiomes(continentalness[i], temperature[i], humidity[i])};
+    }
+    regionBuilds.fetch_add(1, std::memory_order_relaxed);
+    return region;
+}
+
+// Bilinear between the four samples around the column. The biome label is classified from the
+// interpolated climate, so its borders are smooth curves rather than cell-sized steps.
+ClimateSample ClimateMap::interpolate(const Region& region, int localX, int localZ) {
+    const int cellX = localX / CELL_LENGTH;
+    const int cellZ = localZ / CELL_LENGTH;
+    const float tx = static_cast<float>(localX % CELL_LENGTH) / CELL_LENGTH;
+    const float tz = static_cast<float>(localZ % CELL_LENGTH) / CELL_LENGTH;
+    const Point& p00 = region.points[cellX + cellZ * POINTS];
+    const Point& p10 = region.points[cellX + 1 + cellZ * POINTS];
+    const Point& p01 = region.points[cellX + (cellZ + 1) * POINTS];
+    const Point& p11 = region.points[cellX + 1 + (cellZ + 1) * POINTS];
+    const auto blend = [&](auto field) {
+        return lerp(lerp(field(p00), field(p10), tx), lerp(field(p01), field(p11), tx), tz);
+    };
+
+    ClimateSample sample{};
+    sample.continentalness = blend([](const Point& point) { return point.continentalness; });
+    sample.temperature = blend([](const Point& point) { return point.temperature; });
+    sample.humidity = blend([](const Point& point) { return point.humidity; });
+    sample.biome = classify(sample.continentalness, sample.temperature, sample.humidity);
+    sample.parameters.hillAmplitude = blend([](const Point& point) { return point.parameters.hillAmplitude; });
+    sample.parameters.ridgeAmplitude = blend([](const Point& point) { return point.parameters.ridgeAmplitude; });
+    sample.parameters.treeChance = blend([](const Point& point) { return point.parameters.treeChance; });
+    return sample;
+}
+
+} // namespace engine
@@ -0,0 +1,122 @@
+#include <decoration_queue.hpp>
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace engine {
+
+namespace {
+
+// Per target chunk: x, y, z as int32, the write count as uint32, then 3 bytes per write
+constexpr size_t CHUNK_HEADER_SIZE = 16;
+constexpr size_t WRITE_SIZE = 3;
+
+[[noreturn]] void fail() {
+    throw std::runtime_error("Corrupt decoration data!");
+}
+
+void write32(std::vector<uint8_t>& out, uint32_t value) {
+    const size_t offset = out.size();
+    out.resize(offset + sizeof(value));
+    std::memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+uint32_t read32(const uint8_t* in) {
+    uint32_t value;
+    std::memcpy(&value, in, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+void DecorationQueue::push(glm::ivec3 targetChunk, const std::vector<DecorationWrite>& writes) {
+    if (writes.empty()) return;
+    Shard& shard = getShard(targetChunk);
+    std::lock_guard<std::mutex> lock{shard.mutex};
+    std::vector<DecorationWrite>& pending = shard.writes[targetChunk];
+    pending.insert(pending.end(), writes.begin(), writes.end());
+}
+
+bool DecorationQueue::apply(glm::ivec3 chunkCoord, Chunk& chunk) {
+    std::vector<DecorationWrite> writes;
+    {
+        Shard& shard = getShard(chunkCoord);
+        std::lock_guard<std::mutex> lock{shard.mutex};
+        auto pending = shard.writes.find(chunkCoord);
+        if (pending == shard.writes.end()) return false;
+        writes = std::move(pending->second);
+        shard.writes.erase(pending);
+    }
+
+    const size_t length = Chunk::LENGTH;
+    bool changed = false;
+    for (const DecorationWrite& write : writes) {
+        const int x = static_cast<int>(write.index % length);
+        const int y = static_cast<int>(write.index / length % length);
+        const int z = static_cast<int>(write.index / (length * length));
+        if (overrides(write.type, chunk.getBlockUnchecked(x, y, z))) {
+            chunk.setBlockUnchecked(x, y, z, write.type);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void DecorationQueue::encode(std::vector<uint8_t>& out) const {
+    out.assign({VERSION});
+    for (const Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock{shard.mutex};
+        for (const auto& [chunkCoord, writes] : shard.writes) {
+            write32(out, static_cast<uint32_t>(chunkCoord.x));
+            write32(out, static_cast<uint32_t>(chunkCoord.y));
+            write32(out, static_cast<uint32_t>(chunkCoord.z));
+            write32(out, static_cast<uint32_t>(writes.size()));
+            for (const DecorationWrite& write : writes) {
+                out.push_back(static_cast<uint8_t>(write.index));
+                out.push_back(static_cast<uint8_t>(write.index >> 8));
+                out.push_back(static_cast<uint8_t>(write.type));
+            }
+        }
+    }
+}
+
+// Checked whole before anything is pushed
+void DecorationQueue::decode(const uint8_t* data, size_t size) {
+    if (size < 1 || data[0] != VERSION) fail();
+    std::vector<std::pair<glm::ivec3, std::vector<DecorationWrite>>> chunks;
+    for (size_t offset = 1; offset < size;) {
+        if (size - offset < CHUNK_HEADER_SIZE) fail();
+        const glm::ivec3 chunkCoord{
+            static_cast<int32_t>(read32(data + offset)),
+            static_cast<int32_t>(read32(data + offset + 4)),
+            static_cast<int32_t>(read32(data + offset + 8)),
+        };
+        const size_t count = read32(data + offset + 12);
+        offset += CHUNK_HEADER_SIZE;
+        if ((size - offset) / WRITE_SIZE < count) fail();
+
+        std::vector<DecorationWrite> writes(count);
+        for (DecorationWrite& write : writes) {
+            write.index = static_cast<uint16_t>(data[offset] | (data[offset + 1] << 8));
+            if (write.index >= Chunk::SIZE || data[offset + 2] >= NUMBER_OF_TYPES) fail();
+            write.type = static_cast<BlockType>(data[offset + 2]);
+            offset += WRITE_SIZE;
+        }
+        chunks.emplace_back(chunkCoord, std::move(writes));
+    }
+    for (const auto& [chunkCoord, writes] : chunks) {
+        push(chunkCoord, writes);
+    }
+}
+
+size_t DecorationQueue::getPendingChunkCount() const {
+    size_t count = 0;
+    for (const Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock{shard.mutex};
+        count += shard.writes.size();
+    }
+    return count;
+}
+
+} // namespace engine
@@ -129,6 +129,19 @@ void DescriptorPool::resetPool() {
     vkResetDescriptorPool(device.getLogicalDevice(), descriptorPool, 0);
 }
 
+// *************** Descriptor Pool Manager *********************
+
+DescriptorPool& DescriptorPoolManager::allocateDescriptor(const VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet &descriptor) {
+    for (auto &pool : pools) {
+        if (pool->allocateDescriptor(descriptorSetLayout, descriptor)) return *pool;
+    }
+    pools.push_back(poolBuilder.build());
+    if (!pools.back()->allocateDescriptor(descriptorSetLayout, descriptor)) {
+        throw std::runtime_error("Failed to allocate descriptor set from a new pool!");
+    }
+    return *pools.back();
+}
+
 // *************** Descriptor Writer *********************
 
 DescriptorWriter::DescriptorWriter(DescriptorSetLayout &setLayout, DescriptorPool &pool) : setLayout{setLayout}, pool{pool} {}
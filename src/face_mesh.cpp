@@ -0,0 +1,71 @@
+#include <face_mesh.hpp>
+
+#include <cassert>
+#include <stdexcept>
+
+namespace engine {
+
+FaceMesh::FaceMesh(Device& deviceRef, const FaceMesh::Builder& builder, DescriptorSetLayout& setLayout, DescriptorPoolManager& pools,
+    UploadQueue& uploads) : device{deviceRef} {
+    createFaceBuffer(builder.faces, builder.translucentFaces, uploads);
+
+    VkDescriptorBufferInfo bufferInfo = faceBuffer->createDescriptorBufferInfo();
+    pool = &pools.allocateDescriptor(setLayout.getDescriptorSetLayout(), descriptorSet);
+    DescriptorWriter(setLayout, *pool).writeBuffer(0, &bufferInfo).overwrite(descriptorSet);
+}
+
+FaceMesh::~FaceMesh() {
+    std::vector<VkDescriptorSet> descriptorSets{descriptorSet};
+    pool->freeDescriptors(descriptorSets);
+}
+
+void FaceMesh::bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout) {
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipelineLayout,
+        DESCRIPTOR_SET,
+        1,
+        &descriptorSet,
+        0,
+        nullptr
+    );
+}
+
+void FaceMesh::draw(VkCommandBuffer commandBuffer) {
+    if (faceCount == 0) return;
+    vkCmdDraw(commandBuffer, faceCount * 6, 1, 0, 0);
+}
+
+// The translucent records start right after the opaque ones, so gl_VertexIndex / 6 still
+// indexes the whole buffer
+void FaceMesh::drawTranslucent(VkCommandBuffer commandBuffer) {
+    if (translucentFaceCount == 0) return;
+    vkCmdDraw(commandBuffer, translucentFaceCount * 6, 1, faceCount * 6, 0);
+}
+
+void FaceMesh::updateTranslucentFaces(const std::vector<VoxelFace>& translucentFaces, UploadQueue& uploads) {
+    assert(translucentFaces.size() == translucentFaceCount && "A re-sort must keep the translucent faces");
+    uploads.upload(faceBuffer->getBuffer(), sizeof(VoxelFace) * faceCount, translucentFaces.data(), sizeof(VoxelFace) * translucentFaceCount);
+}
+
+void FaceMesh::createFaceBuffer(const std::vector<VoxelFace>& faces, const std::vector<VoxelFace>& translucentFaces, UploadQueue& uploads) {
+    faceCount = static_cast<uint32_t>(faces.size());
+    translucentFaceCount = static_cast<uint32_t>(translucentFaces.size());
+    const uint32_t totalFaceCount = faceCount + translucentFaceCount;
+    assert(totalFaceCount >= 1 && "Face count must be at least 1!");
+    uint32_t faceSize = sizeof(VoxelFace);
+
+    faceBuffer = std::make_unique<Buffer>(
+        device,
+        faceSize,
+        totalFaceCount,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+
+    uploads.upload(faceBuffer->getBuffer(), 0, faces.data(), faceSize * faceCount);
+    uploads.upload(faceBuffer->getBuffer(), faceSize * faceCount, translucentFaces.data(), faceSize * translucentFaceCount);
+}
+
+} // namespace engine
@@ -0,0 +1,163 @@
+#include <face_render_system.hpp>
+#include <face_mesh.hpp>
+
+#define GLM_FORCE_CXX17
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace engine {
+
+struct FacePushConstants {
+    glm::vec4 chunkOrigin{}; // w is the block size
+};
+
+FaceRenderSystem::FaceRenderSystem(Device& deviceRef, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout faceSetLayout) : device{deviceRef} {
+    createPipelineLayout(globalSetLayout, faceSetLayout);
+    createPipeline(renderPass);
+}
+
+FaceRenderSystem::~FaceRenderSystem() {
+    vkDestroyPipelineLayout(device.getLogicalDevice(), pipelineLayout, nullptr);
+}
+
+void FaceRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout faceSetLayout) {
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags    = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset        = 0;
+    pushConstantRange.size          = sizeof(FacePushConstants);
+
+    // Set indices must match FaceMesh::DESCRIPTOR_SET
+    std::vector<VkDescriptorSetLayout> descriptorSetLayouts{globalSetLayout, faceSetLayout};
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType                    = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount           = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts              = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount   = 1;
+    pipelineLayoutInfo.pPushConstantRanges      = &pushConstantRange;
+    if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline layout!");
+    }
+}
+
+void FaceRenderSystem::createPipeline(VkRenderPass renderPass) {
+    assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
+
+    PipelineConfigInfo pipelineConfig{};
+    Pipeline::defaultPipelineConfigInfo(pipelineConfig);
+    pipelineConfig.attributeDescriptions.clear();
+    pipelineConfig.bindingDescriptions.clear();
+    pipelineConfig.renderPass       = renderPass;
+    pipelineConfig.pipelineLayout   = pipelineLayout;
+    pipeline = std::make_unique<Pipeline>(
+        device,
+        "shaders/face.vert.spv",
+        "shaders/voxel.frag.spv",
+        pipelineConfig
+    );
+
+    // Drawn back to front over the finished opaque pass; blended quads must not hide each other
+    Pipeline::enableAlphaBlending(pipelineConfig);
+    pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+    translucentPipeline = std::make_unique<Pipeline>(
+        device,
+        "shaders/face.vert.spv",
+        "shaders/voxel.frag.spv",
+        pipelineConfig
+    );
+}
+
+void FaceRenderSystem::render(FrameInfo& frameInfo) {
+    stats = {};
+    pipeline->bind(frameInfo.commandBuffer);
+
+    vkCmdBindDescriptorSets(
+        frameInfo.commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipelineLayout,
+        0,
+        1,
+        &frameInfo.globalDescriptorSet,
+        0,
+        nullptr
+    );
+
+    for (auto& kv : frameInfo.gameObjects) {
+        auto& obj = kv.second;
+        if (obj.faceMesh == nullptr) continue;
+
+        FacePushConstants push{};
+        push.chunkOrigin = glm::vec4(obj.transform.translation, obj.transform.scale.x);
+
+        vkCmdPushConstants(
+            frameInfo.commandBuffer,
+            pipelineLayout,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0,
+            sizeof(FacePushConstants),
+            &push
+        );
+        obj.faceMesh->bind(frameInfo.commandBuffer, pipelineLayout);
+        obj.faceMesh->draw(frameInfo.commandBuffer);
+
+        stats.drawCalls++;
+        stats.triangleCount += obj.faceMesh->getTriangleCount();
+    }
+}
+
+void FaceRenderSystem::renderTranslucent(FrameInfo& frameInfo) {
+    // Chunks by the distance to their centers; the quads within each were sorted on a worker
+    std::vector<std::pair<float, GameObject*>> sorted;
+    for (auto& kv : frameInfo.gameObjects) {
+        auto& obj = kv.second;
+        if (obj.faceMesh == nullptr || !obj.faceMesh->hasTranslucent()) continue;
+
+        auto offset = frameInfo.camera.getPosition() - (obj.transform.translation + glm::vec3(CHUNK_LENGTH * 0.5f));
+        sorted.emplace_back(glm::dot(offset, offset), &obj);
+    }
+    if (sorted.empty()) return;
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    translucentPipeline->bind(frameInfo.commandBuffer);
+
+    vkCmdBindDescriptorSets(
+        frameInfo.commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipelineLayout,
+        0,
+        1,
+        &frameInfo.globalDescriptorSet,
+        0,
+        nullptr
+    );
+
+    for (auto& entry : sorted) {
+        auto& obj = *entry.second;
+
+        FacePushConstants push{};
+        push.chunkOrigin = glm::vec4(obj.transform.translation, obj.transform.scale.x);
+
+        vkCmdPushConstants(
+            frameInfo.commandBuffer,
+            pipelineLayout,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0,
+            sizeof(FacePushConstants),
+            &push
+        );
+        obj.faceMesh->bind(frameInfo.commandBuffer, pipelineLayout);
+        obj.faceMesh->drawTranslucent(frameInfo.commandBuffer);
+
+        stats.drawCalls++;
+        stats.triangleCount += obj.faceMesh->getTranslucentTriangleCount();
+    }
+}
+
+} // namespace engine
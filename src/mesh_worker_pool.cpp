@@ -0,0 +1,198 @@
+#include <mesh_worker_pool.hpp>
+#include <utils.hpp>
+
+#include <algorithm>
+
+namespace engine {
+
+MeshWorkerPool::MeshWorkerPool(bool faceRecords, unsigned workerCount) : faceRecords{faceRecords} {
+    workerCount = std::max(1u, workerCount);
+    workers.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; i++) {
+        workers.emplace_back(&MeshWorkerPool::workerLoop, this);
+    }
+}
+
+MeshWorkerPool::~MeshWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock{sleepMutex};
+        stopping.store(true);
+    }
+    wakeUp.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned MeshWorkerPool::getDefaultWorkerCount() {
+    const unsigned hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+uint64_t MeshWorkerPool::submit(glm::ivec3 chunkCoord, const ChunkNeighborhood& neighborhood, uint64_t sections, MeshingMode mode) {
+    return submitChunk(chunkCoord, neighborhood, sections, mode, false);
+}
+
+uint64_t MeshWorkerPool::submitWhole(glm::ivec3 chunkCoord, const ChunkNeighborhood& neighborhood, MeshingMode mode) {
+    return submitChunk(chunkCoord, neighborhood, Chunk::ALL_SECTIONS, mode, true);
+}
+
+uint64_t MeshWorkerPool::submitChunk(glm::ivec3 chunkCoord, const ChunkNeighborhood& neighborhood, uint64_t sections, MeshingMode mode,
+    bool whole) {
+    // Both queues have the same capacity, so bounding the in-flight jobs also guarantees a
+    // worker always finds room for its result
+    if (pendingCount.load(std::memory_order_relaxed) >= QUEUE_CAPACITY) return 0;
+
+    std::unique_ptr<Job> job = std::make_unique<Job>();
+    job->chunkCoord = chunkCoord;
+    job->sections = sections;
+    job->version = nextVersion;
+    job->mode = mode;
+    job->whole = whole;
+    job->chunk = *neighborhood.chunk;
+    job->neighborhood = neighborhood;
+    job->neighborhood.chunk = &job->chunk;
+    const uint64_t version = job->version;
+    return pushJob(std::move(job)) ? version : 0;
+}
+
+uint64_t MeshWorkerPool::submitLod(glm::ivec3 chunkCoord, const ChunkLod& lod, const LodNeighborhood::Neighbors& neighbors, int level,
+    MeshingMode mode) {
+    if (pendingCount.load(std::memory_order_relaxed) >= QUEUE_CAPACITY) return 0;
+
+    std::unique_ptr<Job> job = std::make_unique<Job>();
+    job->chunkCoord = chunkCoord;
+    job->version = nextVersion;
+    job->mode = mode;
+    job->lodNeighborhood = LodNeighborhood::gather(lod, neighbors, level);
+    const uint64_t version = job->version;
+    return pushJob(std::move(job)) ? version : 0;
+}
+
+bool MeshWorkerPool::pushJob(std::unique_ptr<Job> job) {
+    pendingCount.fetch_add(1, std::memory_order_relaxed);
+    if (!jobs.tryPush(std::move(job))) {
+        pendingCount.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    nextVersion++;
+    wakeWorker();
+    return true;
+}
+
+bool MeshWorkerPool::submitSort(SortJob&& job) {
+    if (pendingSortCount.load(std::memory_order_relaxed) >= QUEUE_CAPACITY) return false;
+
+    std::unique_ptr<SortJob> sort = std::make_unique<SortJob>(std::move(job));
+    pendingSortCount.fetch_add(1, std::memory_order_relaxed);
+    if (!sortJobs.tryPush(std::move(sort))) {
+        pendingSortCount.fetch_sub(1, std::memory_order_relaxed);
+        job = std::move(*sort);
+        return false;
+    }
+    wakeWorker();
+    return true;
+}
+
+bool MeshWorkerPool::tryPopSorted(SortJob& out) {
+    std::unique_ptr<SortJob> sorted;
+    if (!sortResults.tryPop(sorted)) return false;
+    out = std::move(*sorted);
+    pendingSortCount.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+void MeshWorkerPool::wakeWorker() {
+    // Taking the lock orders the increment against a worker that just found nothing to do
+    // and is about to sleep, so the wake-up cannot be lost
+    {
+        std::lock_guard<std::mutex> lock{sleepMutex};
+        queuedJobs.fetch_add(1);
+    }
+    wakeUp.notify_one();
+}
+
+bool MeshWorkerPool::tryPopResult(MeshResult& out) {
+    std::unique_ptr<MeshResult> result;
+    if (!results.tryPop(result)) return false;
+    out = std::move(*result);
+    pendingCount.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+void MeshWorkerPool::workerLoop() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock{sleepMutex};
+            wakeUp.wait(lock, [this]() { return stopping.load() || queuedJobs.load() > 0; });
+            if (stopping.load()) return;
+            queuedJobs.fetch_sub(1);
+        }
+
+        // A claimed job is always in one of the queues, though another worker may pop it first
+        // and leave this one with a later job; either way one pop per claim succeeds eventually.
+        // Sorts go first: they are short and their chunks are already on screen.
+        for (;;) {
+            std::unique_ptr<SortJob> sort;
+            if (sortJobs.tryPop(sort)) {
+                sortMesh(std::move(sort));
+                break;
+            }
+            std::unique_ptr<Job> job;
+            if (jobs.tryPop(job)) {
+                meshChunk(std::move(job));
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+void MeshWorkerPool::meshChunk(std::unique_ptr<Job> job) {
+    std::unique_ptr<MeshResult> result = std::make_unique<MeshResult>();
+    result->chunkCoord = job->chunkCoord;
+    result->sections = job->sections;
+    result->version = job->version;
+    result->whole = job->whole;
+    if (!job->lodNeighborhood.cells.empty()) {
+        result->lodLevel = job->lodNeighborhood.level;
+        if (faceRecords) {
+            ChunkMesher::buildLodMesh(job->lodNeighborhood, result->lodFaces, job->mode);
+        } else {
+            ChunkMesher::buildLodMesh(job->lodNeighborhood, result->lodVertices, job->mode);
+        }
+    } else if (!job->chunk.isEmpty() && job->whole) {
+        if (faceRecords) {
+            ChunkMesher::buildMesh(job->neighborhood, result->mesh.faces[0], job->mode);
+        } else {
+            ChunkMesher::buildMesh(job->neighborhood, result->mesh.vertices[0], job->mode);
+        }
+    } else if (!job->chunk.isEmpty()) {
+        for (uint64_t remaining = job->sections; remaining != 0; remaining &= remaining - 1) {
+            const size_t section = static_cast<size_t>(countTrailingZeros(remaining));
+            if (faceRecords) {
+                ChunkMesher::buildSectionMesh(job->neighborhood, result->mesh.faces[section], section, job->mode);
+            } else {
+                ChunkMesher::buildSectionMesh(job->neighborhood, result->mesh.vertices[section], section, job->mode);
+            }
+        }
+    }
+    job.reset();
+
+    while (!results.tryPush(std::move(result))) {
+        std::this_thread::yield();
+    }
+}
+
+void MeshWorkerPool::sortMesh(std::unique_ptr<SortJob> job) {
+    if (faceRecords) {
+        ChunkMesher::sortTranslucentFaces(job->faces, job->viewPosition);
+    } else {
+        ChunkMesher::sortTranslucentFaces(job->vertices, job->viewPosition);
+    }
+    while (!sortResults.tryPush(std::move(job))) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace engine
@@ -0,0 +1,238 @@
+#include <noise.hpp>
+#include <noise_kernels.hpp>
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace engine {
+
+namespace {
+
+struct ScalarLanes {
+    static constexpr size_t WIDTH = 1;
+    using F = float;
+    using I = uint32_t;
+    using M = bool;
+
+    static F splat(float value) { return value; }
+    static F load(const float* in) { return *in; }
+    static void store(float* out, F value) { *out = value; }
+    static F add(F a, F b) { return a + b; }
+    static F sub(F a, F b) { return a - b; }
+    static F mul(F a, F b) { return a * b; }
+    static F floor(F a) { return std::floor(a); }
+    static F abs(F a) { return std::fabs(a); }
+    static F neg(F a) { return -a; }
+    static F select(M mask, F a, F b) { return mask ? a : b; }
+    static M lessThan(F a, F b) { return a < b; }
+    static M notMask(M a) { return !a; }
+    static M andMask(M a, M b) { return a && b; }
+    static M orMask(M a, M b) { return a || b; }
+
+    static I splatInt(uint32_t value) { return value; }
+    static I toInt(F a) { return static_cast<uint32_t>(static_cast<int32_t>(a)); }
+    static I addInt(I a, I b) { return a + b; }
+    static I mulInt(I a, I b) { return a * b; }
+    static I xorInt(I a, I b) { return a ^ b; }
+    static I shiftRight(I a, int bits) { return a >> bits; }
+    static M testBits(I h, uint32_t mask, uint32_t value) { return (h & mask) == value; }
+};
+
+FractalParams expand(const NoiseSettings& settings, uint32_t seed) {
+    assert(settings.octaves >= 1 && settings.octaves <= NoiseSettings::MAX_OCTAVES && "Noise octave count out of range");
+    FractalParams params{};
+    params.type = settings.type;
+    params.fractal = settings.fractal;
+    params.octaves = settings.octaves;
+    float frequency = settings.frequency;
+    float amplitude = 1.f;
+    float total = 0.f;
+    for (int index = 0; index < settings.octaves; index++) {
+        params.frequencies[index] = frequency;
+        params.amplitudes[index] = amplitude;
+        params.seeds[index] = seed + static_cast<uint32_t>(index) * 0x9e3779b9u; // decorrelates the octaves
+        total += amplitude;
+        frequency *= settings.lacunarity;
+        amplitude *= settings.gain;
+    }
+    params.scale = 1.f / total;
+    return params;
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+void cpuid(int leaf, int subleaf, unsigned registers[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int out[4];
+    __cpuidex(out, leaf, subleaf);
+    for (int i = 0; i < 4; i++) registers[i] = static_cast<unsigned>(out[i]);
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// Whether the OS saves the YMM registers on context switches (XCR0 bits 1 and 2)
+bool isAvxStateEnabled() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return (_xgetbv(0) & 0x6) == 0x6;
+#else
+    unsigned eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (eax & 0x6) == 0x6;
+#endif
+}
+#endif
+
+void fillNoise(NoiseBackend backend, const FractalParams& params, const float* x, const float* y, float* out, size_t count) {
+    switch (backend) {
+#if defined(__x86_64__) || defined(_M_X64)
+        case NOISE_BACKEND_AVX2: fillNoiseAvx2(params, x, y, out, count); break;
+        case NOISE_BACKEND_SSE41: fillNoiseSse41(params, x, y, out, count); break;
+#endif
+        default: fillNoiseScalar(params, x, y, out, count); break;
+    }
+}
+
+void fillNoise(NoiseBackend backend, const FractalParams& params, const float* x, const float* y, const float* z, float* out,
+    size_t count) {
+    switch (backend) {
+#if defined(__x86_64__) || defined(_M_X64)
+        case NOISE_BACKEND_AVX2: fillNoiseAvx2(params, x, y, z, out, count); break;
+        case NOISE_BACKEND_SSE41: fillNoiseSse41(params, x, y, z, out, count); break;
+#endif
+        default: fillNoiseScalar(params, x, y, z, out, count); break;
+    }
+}
+
+void upsampleGrid(NoiseBackend backend, const float* lattice, int step, float* out) {
+    switch (backend) {
+#if defined(__x86_64__) || defined(_M_X64)
+        case NOISE_BACKEND_AVX2: upsampleGridAvx2(lattice, step, out); break;
+        case NOISE_BACKEND_SSE41: upsampleGridSse41(lattice, step, out); break;
+#endif
+        default: upsampleGridScalar(lattice, step, out); break;
+    }
+}
+
+} // namespace
+
+void fillNoiseScalar(const FractalParams& params, const float* x, const float* y, float* out, size_t count) {
+    NoiseKernel<ScalarLanes>::fill(params, x, y, out, count);
+}
+
+void fillNoiseScalar(const FractalParams& params, const float* x, const float* y, const float* z, float* out, size_t count) {
+    NoiseKernel<ScalarLanes>::fill(params, x, y, z, out, count);
+}
+
+void upsampleGridScalar(const float* lattice, int step, float* out) {
+    NoiseKernel<ScalarLanes>::upsample(lattice, step, out);
+}
+
+bool Noise::isBackendSupported(NoiseBackend backend) {
+    if (backend == NOISE_BACKEND_SCALAR) return true;
+#if defined(__x86_64__) || defined(_M_X64)
+    unsigned registers[4];
+    cpuid(0, 0, registers);
+    const unsigned maxLeaf = registers[0];
+    cpuid(1, 0, registers);
+    const bool sse41 = (registers[2] >> 19) & 1;
+    const bool osxsave = (registers[2] >> 27) & 1;
+    if (backend == NOISE_BACKEND_SSE41) return sse41;
+    if (backend == NOISE_BACKEND_AVX2) {
+        if (maxLeaf < 7 || !osxsave || !isAvxStateEnabled()) return false;
+        cpuid(7, 0, registers);
+        return (registers[1] >> 5) & 1;
+    }
+#endif
+    return false;
+}
+
+NoiseBackend Noise::getBestBackend() {
+    static const NoiseBackend best = isBackendSupported(NOISE_BACKEND_AVX2) ? NOISE_BACKEND_AVX2
+        : (isBackendSupported(NOISE_BACKEND_SSE41) ? NOISE_BACKEND_SSE41 : NOISE_BACKEND_SCALAR);
+    return best;
+}
+
+Noise::Noise(uint32_t seed, NoiseBackend backend) : seed{seed}, backend{backend} {
+    if (!isBackendSupported(backend)) {
+        throw std::runtime_error("Noise backend not supported by this CPU!");
+    }
+}
+
+float Noise::sample(const NoiseSettings& settings, float x, float y) const {
+    float value;
+    fillNoiseScalar(expand(settings, seed), &x, &y, &value, 1);
+    return value;
+}
+
+float Noise::sample(const NoiseSettings& settings, float x, float y, float z) const {
+    float value;
+    fillNoiseScalar(expand(settings, seed), &x, &y, &z, &value, 1);
+    return value;
+}
+
+void Noise::fill(const NoiseSettings& settings, const float* x, const float* y, float* out, size_t count) const {
+    fillNoise(backend, expand(settings, seed), x, y, out, count);
+}
+
+void Noise::fill(const NoiseSettings& settings, const float* x, const float* y, const float* z, float* out, size_t count) const {
+    fillNoise(backend, expand(settings, seed), x, y, z, out, count);
+}
+
+void Noise::fillPlane(const NoiseSettings& settings, glm::ivec2 origin, float* out) const {
+    constexpr int length = static_cast<int>(CHUNK_LENGTH);
+    std::array<float, CHUNK_LENGTH * CHUNK_LENGTH> x;
+    std::array<float, CHUNK_LENGTH * CHUNK_LENGTH> z;
+    for (int i = 0; i < length * length; i++) {
+        x[i] = static_cast<float>(origin.x + i % length);
+        z[i] = static_cast<float>(origin.y + i / length);
+    }
+    fillNoise(backend, expand(settings, seed), x.data(), z.data(), out, x.size());
+}
+
+// One xy slice at a time, which keeps the coordinates on the stack
+void Noise::fillGrid(const NoiseSettings& settings, glm::ivec3 origin, float* out) const {
+    constexpr int length = static_cast<int>(CHUNK_LENGTH);
+    const FractalParams params = expand(settings, seed);
+    std::array<float, CHUNK_LENGTH * CHUNK_LENGTH> x;
+    std::array<float, CHUNK_LENGTH * CHUNK_LENGTH> y;
+    std::array<float, CHUNK_LENGTH * CHUNK_LENGTH> z;
+    for (int i = 0; i < length * length; i++) {
+        x[i] = static_cast<float>(origin.x + i % length);
+        y[i] = static_cast<float>(origin.y + i / length);
+    }
+    for (int slice = 0; slice < length; slice++) {
+        z.fill(static_cast<float>(origin.z + slice));
+        fillNoise(backend, params, x.data(), y.data(), z.data(), out + static_cast<size_t>(slice) * x.size(), x.size());
+    }
+}
+
+void Noise::fillGridCoarse(const NoiseSettings& settings, glm::ivec3 origin, int step, float* out) const {
+    assert(step >= 1 && step <= static_cast<int>(CHUNK_LENGTH) && (step & (step - 1)) == 0 && "Noise lattice step must be a power of two");
+    const int points = static_cast<int>(CHUNK_LENGTH) / step + 1;
+    const size_t count = static_cast<size_t>(points * points * points);
+    std::vector<float> x(count);
+    std::vector<float> y(count);
+    std::vector<float> z(count);
+    for (size_t i = 0; i < count; i++) {
+        const int index = static_cast<int>(i);
+        x[i] = static_cast<float>(origin.x + index % points * step);
+        y[i] = static_cast<float>(origin.y + index / points % points * step);
+        z[i] = static_cast<float>(origin.z + index / (points * points) * step);
+    }
+    std::vector<float> lattice(count);
+    fillNoise(backend, expand(settings, seed), x.data(), y.data(), z.data(), lattice.data(), count);
+    upsampleGrid(backend, lattice.data(), step, out);
+}
+
+} // namespace engine
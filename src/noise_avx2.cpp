@@ -0,0 +1,60 @@
+// Built with AVX2 enabled (see CMakeLists.txt); only called once Noise has checked the CPU
+#include <noise_kernels.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+namespace engine {
+
+namespace {
+
+struct Avx2Lanes {
+    static constexpr size_t WIDTH = 8;
+    using F = __m256;
+    using I = __m256i;
+    using M = __m256;
+
+    static F splat(float value) { return _mm256_set1_ps(value); }
+    static F load(const float* in) { return _mm256_loadu_ps(in); }
+    static void store(float* out, F value) { _mm256_storeu_ps(out, value); }
+    static F add(F a, F b) { return _mm256_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    static F floor(F a) { return _mm256_floor_ps(a); }
+    static F abs(F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+    static F neg(F a) { return _mm256_xor_ps(_mm256_set1_ps(-0.f), a); }
+    static F select(M mask, F a, F b) { return _mm256_blendv_ps(b, a, mask); }
+    static M lessThan(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static M notMask(M a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+    static M andMask(M a, M b) { return _mm256_and_ps(a, b); }
+    static M orMask(M a, M b) { return _mm256_or_ps(a, b); }
+
+    static I splatInt(uint32_t value) { return _mm256_set1_epi32(static_cast<int>(value)); }
+    static I toInt(F a) { return _mm256_cvttps_epi32(a); }
+    static I addInt(I a, I b) { return _mm256_add_epi32(a, b); }
+    static I mulInt(I a, I b) { return _mm256_mullo_epi32(a, b); }
+    static I xorInt(I a, I b) { return _mm256_xor_si256(a, b); }
+    static I shiftRight(I a, int bits) { return _mm256_srli_epi32(a, bits); }
+    static M testBits(I h, uint32_t mask, uint32_t value) {
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(h, splatInt(mask)), splatInt(value)));
+    }
+};
+
+} // namespace
+
+void fillNoiseAvx2(const FractalParams& params, const float* x, const float* y, float* out, size_t count) {
+    NoiseKernel<Avx2Lanes>::fill(params, x, y, out, count);
+}
+
+void fillNoiseAvx2(const FractalParams& params, const float* x, const float* y, const float* z, float* out, size_t count) {
+    NoiseKernel<Avx2Lanes>::fill(params, x, y, z, out, count);
+}
+
+void upsampleGridAvx2(const float* lattice, int step, float* out) {
+    NoiseKernel<Avx2Lanes>::upsample(lattice, step, out);
+}
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,60 @@
+// Built with SSE4.1 enabled (see CMakeLists.txt); only called once Noise has checked the CPU
+#include <noise_kernels.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <smmintrin.h>
+
+namespace engine {
+
+namespace {
+
+struct Sse41Lanes {
+    static constexpr size_t WIDTH = 4;
+    using F = __m128;
+    using I = __m128i;
+    using M = __m128;
+
+    static F splat(float value) { return _mm_set1_ps(value); }
+    static F load(const float* in) { return _mm_loadu_ps(in); }
+    static void store(float* out, F value) { _mm_storeu_ps(out, value); }
+    static F add(F a, F b) { return _mm_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F floor(F a) { return _mm_floor_ps(a); }
+    static F abs(F a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+    static F neg(F a) { return _mm_xor_ps(_mm_set1_ps(-0.f), a); }
+    static F select(M mask, F a, F b) { return _mm_blendv_ps(b, a, mask); }
+    static M lessThan(F a, F b) { return _mm_cmplt_ps(a, b); }
+    static M notMask(M a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+    static M andMask(M a, M b) { return _mm_and_ps(a, b); }
+    static M orMask(M a, M b) { return _mm_or_ps(a, b); }
+
+    static I splatInt(uint32_t value) { return _mm_set1_epi32(static_cast<int>(value)); }
+    static I toInt(F a) { return _mm_cvttps_epi32(a); }
+    static I addInt(I a, I b) { return _mm_add_epi32(a, b); }
+    static I mulInt(I a, I b) { return _mm_mullo_epi32(a, b); }
+    static I xorInt(I a, I b) { return _mm_xor_si128(a, b); }
+    static I shiftRight(I a, int bits) { return _mm_srli_epi32(a, bits); }
+    static M testBits(I h, uint32_t mask, uint32_t value) {
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, splatInt(mask)), splatInt(value)));
+    }
+};
+
+} // namespace
+
+void fillNoiseSse41(const FractalParams& params, const float* x, const float* y, float* out, size_t count) {
+    NoiseKernel<Sse41Lanes>::fill(params, x, y, out, count);
+}
+
+void fillNoiseSse41(const FractalParams& params, const float* x, const float* y, const float* z, float* out, size_t count) {
+    NoiseKernel<Sse41Lanes>::fill(params, x, y, z, out, count);
+}
+
+void upsampleGridSse41(const float* lattice, int step, float* out) {
+    NoiseKernel<Sse41Lanes>::upsample(lattice, step, out);
+}
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,302 @@
+#include <region_file.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace engine {
+
+namespace {
+
+constexpr char MAGIC[4] = {'V', 'X', 'R', 'G'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t TABLE_OFFSET = 16; // magic, version, reserved
+constexpr size_t HEADER_SIZE = TABLE_OFFSET + RegionFile::CHUNK_COUNT * 2 * sizeof(uint32_t);
+constexpr size_t HEADER_SECTORS = (HEADER_SIZE + RegionFile::SECTOR_SIZE - 1) / RegionFile::SECTOR_SIZE;
+
+int floorDiv(int value, int divisor) {
+    return (value >= 0 ? value : value - divisor + 1) / divisor;
+}
+
+std::string getSystemError() {
+#ifdef _WIN32
+    return "error " + std::to_string(GetLastError());
+#else
+    return std::strerror(errno);
+#endif
+}
+
+} // namespace
+
+RegionFile::RegionFile(const std::string& path) : path{path} {
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open region file: " + path + "\tReason: " + getSystemError());
+    }
+    file = handle;
+    LARGE_INTEGER fileSize{};
+    GetFileSizeEx(handle, &fileSize);
+    const size_t existingSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    file = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (file < 0) {
+        throw std::runtime_error("Failed to open region file: " + path + "\tReason: " + getSystemError());
+    }
+    struct stat status{};
+    fstat(file, &status);
+    const size_t existingSize = static_cast<size_t>(status.st_size);
+#endif
+
+    try {
+        if (existingSize == 0) {
+            map(HEADER_SECTORS * SECTOR_SIZE); // the new table is zero-filled: no chunks
+            std::memcpy(data, MAGIC, sizeof(MAGIC));
+            std::memcpy(data + sizeof(MAGIC), &VERSION, sizeof(VERSION));
+        } else {
+            if (existingSize < HEADER_SIZE) throw std::runtime_error("Not a region file: " + path);
+            map(getSectorCount(existingSize) * SECTOR_SIZE);
+            uint32_t version = 0;
+            std::memcpy(&version, data + sizeof(MAGIC), sizeof(version));
+            if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) throw std::runtime_error("Not a region file: " + path);
+            if (version != VERSION) {
+                throw std::runtime_error("Unsupported region file version " + std::to_string(version) + ": " + path);
+            }
+        }
+
+        usedSectors.assign(size / SECTOR_SIZE, false);
+        std::fill(usedSectors.begin(), usedSectors.begin() + HEADER_SECTORS, true);
+        for (size_t index = 0; index < CHUNK_COUNT; index++) {
+            const Extent entry = readEntry(index);
+            if (entry.sector == 0) continue;
+            const size_t end = entry.sector + getSectorCount(entry.size);
+            if (entry.sector < HEADER_SECTORS || end > usedSectors.size()) {
+                throw std::runtime_error("Corrupt region file: " + path);
+            }
+            std::fill(usedSectors.begin() + entry.sector, usedSectors.begin() + end, true);
+        }
+    } catch (...) {
+        unmap();
+#ifdef _WIN32
+        CloseHandle(file);
+#else
+        ::close(file);
+#endif
+        throw;
+    }
+}
+
+RegionFile::~RegionFile() {
+    flush();
+    unmap();
+#ifdef _WIN32
+    CloseHandle(file);
+#else
+    ::close(file);
+#endif
+}
+
+glm::ivec2 RegionFile::getRegionCoord(glm::ivec3 chunkCoord) {
+    return {floorDiv(chunkCoord.x, LENGTH), floorDiv(chunkCoord.z, LENGTH)};
+}
+
+bool RegionFile::read(glm::ivec3 chunkCoord, const std::function<void(const uint8_t* data, size_t size)>& consume) const {
+    std::shared_lock<std::shared_mutex> lock{mutex};
+    const Extent entry = readEntry(getEntryIndex(chunkCoord));
+    if (entry.sector == 0) return false;
+    consume(data + entry.getOffset(), entry.size);
+    return true;
+}
+
+void RegionFile::write(glm::ivec3 chunkCoord, const uint8_t* payload, size_t payloadSize) {
+    assert(payloadSize > 0 && "RegionFile::write payload must not be empty");
+    if (payloadSize > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Chunk payload too large for region file: " + path);
+    }
+    std::unique_lock<std::shared_mutex> lock{mutex};
+    const size_t index = getEntryIndex(chunkCoord);
+    const Extent previous = readEntry(index);
+
+    const size_t sector = allocate(getSectorCount(payloadSize));
+    std::memcpy(data + sector * SECTOR_SIZE, payload, payloadSize);
+    writeEntry(index, {static_cast<uint32_t>(sector), static_cast<uint32_t>(payloadSize)});
+    free(previous);
+}
+
+// Pinned under the shared lock, so a rewrite (under the exclusive one) either comes first and
+// is what this reads, or sees the pin and keeps the old sectors
+bool RegionFile::beginRead(glm::ivec3 chunkCoord, Extent& extent) {
+    std::shared_lock<std::shared_mutex> lock{mutex};
+    extent = readEntry(getEntryIndex(chunkCoord));
+    if (extent.sector == 0) return false;
+    pinnedReads.fetch_add(1);
+    return true;
+}
+
+// Sectors freed while reads were pinned are released once none are. That is later than needed
+// for the sectors no remaining read uses, but reads are short, so the count drops to zero
+// between batches.
+void RegionFile::endRead() {
+    if (pinnedReads.fetch_sub(1) != 1) return;
+    std::unique_lock<std::shared_mutex> lock{mutex};
+    if (pinnedReads.load() != 0) return;
+    for (Extent extent : deferredFrees) {
+        free(extent);
+    }
+    deferredFrees.clear();
+}
+
+RegionFile::Extent RegionFile::reserve(size_t payloadSize) {
+    assert(payloadSize > 0 && "RegionFile::reserve payload must not be empty");
+    if (payloadSize > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Chunk payload too large for region file: " + path);
+    }
+    std::unique_lock<std::shared_mutex> lock{mutex};
+    return {static_cast<uint32_t>(allocate(getSectorCount(payloadSize))), static_cast<uint32_t>(payloadSize)};
+}
+
+void RegionFile::commit(glm::ivec3 chunkCoord, Extent extent) {
+    std::unique_lock<std::shared_mutex> lock{mutex};
+    const size_t index = getEntryIndex(chunkCoord);
+    const Extent previous = readEntry(index);
+    writeEntry(index, extent);
+    free(previous);
+}
+
+// Never pinned: no read can have found sectors that were not committed
+void RegionFile::release(Extent extent) {
+    std::unique_lock<std::shared_mutex> lock{mutex};
+    const auto first = usedSectors.begin() + extent.sector;
+    std::fill(first, first + getSectorCount(extent.size), false);
+}
+
+void RegionFile::flush() {
+    std::shared_lock<std::shared_mutex> lock{mutex};
+#ifdef _WIN32
+    FlushViewOfFile(data, size);
+    FlushFileBuffers(file);
+#else
+    msync(data, size, MS_SYNC);
+#endif
+}
+
+size_t RegionFile::getFileSize() const {
+    std::shared_lock<std::shared_mutex> lock{mutex};
+    return size;
+}
+
+size_t RegionFile::getEntryIndex(glm::ivec3 chunkCoord) {
+    assert(isStorable(chunkCoord) && "RegionFile chunk y out of range");
+    const glm::ivec2 regionCoord = getRegionCoord(chunkCoord);
+    const int x = chunkCoord.x - regionCoord.x * LENGTH;
+    const int z = chunkCoord.z - regionCoord.y * LENGTH;
+    const int y = chunkCoord.y - MIN_CHUNK_Y;
+    return static_cast<size_t>(x + (z + y * LENGTH) * LENGTH);
+}
+
+RegionFile::Extent RegionFile::readEntry(size_t index) const {
+    Extent entry{};
+    const uint8_t* slot = data + TABLE_OFFSET + index * 2 * sizeof(uint32_t);
+    std::memcpy(&entry.sector, slot, sizeof(uint32_t));
+    std::memcpy(&entry.size, slot + sizeof(uint32_t), sizeof(uint32_t));
+    return entry;
+}
+
+void RegionFile::writeEntry(size_t index, Extent entry) {
+    uint8_t* slot = data + TABLE_OFFSET + index * 2 * sizeof(uint32_t);
+    std::memcpy(slot, &entry.sector, sizeof(uint32_t));
+    std::memcpy(slot + sizeof(uint32_t), &entry.size, sizeof(uint32_t));
+}
+
+// First fit. Without a gap large enough the file grows by at least a quarter, so appending
+// chunk after chunk remaps the file a logarithmic number of times.
+size_t RegionFile::allocate(size_t sectors) {
+    size_t start = HEADER_SECTORS;
+    for (size_t sector = HEADER_SECTORS; sector < usedSectors.size(); sector++) {
+        if (usedSectors[sector]) {
+            start = sector + 1;
+        } else if (sector + 1 - start == sectors) {
+            break;
+        }
+    }
+    if (start + sectors > usedSectors.size()) {
+        const size_t total = std::max(start + sectors, usedSectors.size() + usedSectors.size() / 4);
+        map(total * SECTOR_SIZE);
+        usedSectors.resize(total, false);
+    }
+    std::fill(usedSectors.begin() + start, usedSectors.begin() + start + sectors, true);
+    return start;
+}
+
+void RegionFile::free(Extent extent) {
+    if (extent.sector == 0) return;
+    if (pinnedReads.load() != 0) {
+        deferredFrees.push_back(extent);
+        return;
+    }
+    const auto first = usedSectors.begin() + extent.sector;
+    std::fill(first, first + getSectorCount(extent.size), false);
+}
+
+// Maps the first newSize bytes of the file, growing it (zero-filled) if it is shorter. The new
+// view is made before the old one goes, so when this throws the region keeps its old mapping
+// and stays usable at its old size.
+void RegionFile::map(size_t newSize) {
+#ifdef _WIN32
+    const DWORD high = static_cast<DWORD>(static_cast<uint64_t>(newSize) >> 32);
+    const DWORD low = static_cast<DWORD>(newSize & 0xffffffffu);
+    HANDLE newMapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, high, low, nullptr);
+    void* view = newMapping != nullptr ? MapViewOfFile(newMapping, FILE_MAP_ALL_ACCESS, 0, 0, newSize) : nullptr;
+    if (view == nullptr) {
+        const std::string reason = getSystemError();
+        if (newMapping != nullptr) CloseHandle(newMapping);
+        throw std::runtime_error("Failed to map region file: " + path + "\tReason: " + reason);
+    }
+#else
+    struct stat status{};
+    fstat(file, &status);
+    if (static_cast<size_t>(status.st_size) < newSize && ftruncate(file, static_cast<off_t>(newSize)) != 0) {
+        throw std::runtime_error("Failed to grow region file: " + path + "\tReason: " + getSystemError());
+    }
+    void* view = mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Failed to map region file: " + path + "\tReason: " + getSystemError());
+    }
+#endif
+    unmap();
+#ifdef _WIN32
+    mapping = newMapping;
+#endif
+    data = static_cast<uint8_t*>(view);
+    size = newSize;
+}
+
+void RegionFile::unmap() {
+#ifdef _WIN32
+    if (data != nullptr) UnmapViewOfFile(data);
+    if (mapping != nullptr) CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    if (data != nullptr) munmap(data, size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+} // namespace engine
@@ -10,10 +10,11 @@
 
 namespace engine {
 
+// Two mat4s already fill the 128 bytes of push constants every device guarantees; chunk
+// terrain is drawn by VoxelRenderSystem, which only pushes the chunk origin
 struct PushConstantData {
     glm::mat4 modelMatrix{1.f};
     glm::mat4 normalMatrix{1.f};
-    // glm::vec3 chunkOffset{};
 };
 
 RenderSystem::RenderSystem(Device& deviceRef, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : device{deviceRef} {
@@ -60,6 +61,7 @@ void RenderSystem::createPipeline(VkRenderPass renderPass) {
 }
 
 void RenderSystem::renderGameObjects(FrameInfo& frameInfo) {
+    stats = {};
     pipeline->bind(frameInfo.commandBuffer);
 
     vkCmdBindDescriptorSets(
@@ -80,7 +82,6 @@ void RenderSystem::renderGameObjects(FrameInfo& frameInfo) {
         PushConstantData push{};
         push.modelMatrix = obj.transform.mat4();
         push.normalMatrix = obj.transform.normalMatrix();
-        // push.chunkOffset = ...????; // TODO
 
         vkCmdPushConstants(
             frameInfo.commandBuffer,
@@ -92,6 +93,9 @@ void RenderSystem::renderGameObjects(FrameInfo& frameInfo) {
         );
         obj.model->bind(frameInfo.commandBuffer);
         obj.model->draw(frameInfo.commandBuffer);
+
+        stats.drawCalls++;
+        stats.triangleCount += obj.model->getTriangleCount();
     }
 }
 
@@ -0,0 +1,132 @@
+#include <upload_queue.hpp>
+
+#include <stdexcept>
+
+namespace engine {
+
+UploadQueue::UploadQueue(Device& deviceRef) : device{deviceRef} {}
+
+UploadQueue::~UploadQueue() {
+    if (recording.commandBuffer != VK_NULL_HANDLE) {
+        vkEndCommandBuffer(recording.commandBuffer);
+        vkFreeCommandBuffers(device.getLogicalDevice(), device.getCommandPool(), 1, &recording.commandBuffer);
+    }
+    for (Batch& batch : inFlight) {
+        vkWaitForFences(device.getLogicalDevice(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+        release(batch);
+    }
+    for (VkFence fence : idleFences) {
+        vkDestroyFence(device.getLogicalDevice(), fence, nullptr);
+    }
+}
+
+void UploadQueue::upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+    if (size == 0) return;
+    if (recording.commandBuffer == VK_NULL_HANDLE) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType                 = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level                 = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool           = device.getCommandPool();
+        allocInfo.commandBufferCount    = 1;
+        if (vkAllocateCommandBuffers(device.getLogicalDevice(), &allocInfo, &recording.commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate upload command buffer!");
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(recording.commandBuffer, &beginInfo);
+
+        // Write after read: frames in flight may still draw from a range being rewritten
+        vkCmdPipelineBarrier(
+            recording.commandBuffer,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            0, nullptr,
+            0, nullptr,
+            0, nullptr
+        );
+    }
+
+    auto stagingBuffer = std::make_unique<Buffer>(
+        device,
+        size,
+        1,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+    stagingBuffer->map();
+    stagingBuffer->writeToBuffer(const_cast<void*>(data), size);
+    stagingBuffer->unmap();
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset    = 0;
+    copyRegion.dstOffset    = dstOffset;
+    copyRegion.size         = size;
+    vkCmdCopyBuffer(recording.commandBuffer, stagingBuffer->getBuffer(), dstBuffer, 1, &copyRegion);
+    recording.stagingBuffers.push_back(std::move(stagingBuffer));
+}
+
+// The barrier makes the copies visible to the vertex input and vertex shader reads of
+// everything submitted to the queue after the batch
+void UploadQueue::submit() {
+    if (recording.commandBuffer == VK_NULL_HANDLE) return;
+
+    VkMemoryBarrier barrier{};
+    barrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask   = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(
+        recording.commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        0,
+        1, &barrier,
+        0, nullptr,
+        0, nullptr
+    );
+    vkEndCommandBuffer(recording.commandBuffer);
+
+    if (idleFences.empty()) {
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkFence fence;
+        if (vkCreateFence(device.getLogicalDevice(), &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create upload fence!");
+        }
+        idleFences.push_back(fence);
+    }
+    recording.fence = idleFences.back();
+    idleFences.pop_back();
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount   = 1;
+    submitInfo.pCommandBuffers      = &recording.commandBuffer;
+    if (vkQueueSubmit(device.getGraphicsQueue(), 1, &submitInfo, recording.fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit mesh uploads!");
+    }
+    inFlight.push_back(std::move(recording));
+    recording = Batch{};
+}
+
+void UploadQueue::collect() {
+    for (auto batch = inFlight.begin(); batch != inFlight.end();) {
+        if (vkGetFenceStatus(device.getLogicalDevice(), batch->fence) != VK_SUCCESS) {
+            ++batch;
+            continue;
+        }
+        release(*batch);
+        batch = inFlight.erase(batch);
+    }
+}
+
+void UploadQueue::release(Batch& batch) {
+    vkFreeCommandBuffers(device.getLogicalDevice(), device.getCommandPool(), 1, &batch.commandBuffer);
+    vkResetFences(device.getLogicalDevice(), 1, &batch.fence);
+    idleFences.push_back(batch.fence);
+    batch.stagingBuffers.clear();
+}
+
+} // namespace engine
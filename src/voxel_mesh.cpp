@@ -0,0 +1,94 @@
+#include <voxel_mesh.hpp>
+
+#include <cassert>
+#include <cstddef>
+
+namespace engine {
+
+VoxelMesh::VoxelMesh(Device& deviceRef, const VoxelMesh::Builder& builder, UploadQueue& uploads) : device{deviceRef} {
+    createVertexBuffer(builder.vertices, uploads);
+    createIndexBuffer(builder.indices, builder.translucentIndices, uploads);
+}
+
+VoxelMesh::~VoxelMesh() {}
+
+void VoxelMesh::bind(VkCommandBuffer commandBuffer) {
+    VkBuffer buffers[] {vertexBuffer->getBuffer()};
+    VkDeviceSize offsets[] {0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+}
+
+void VoxelMesh::draw(VkCommandBuffer commandBuffer) {
+    if (indexCount == 0) return;
+    vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+}
+
+void VoxelMesh::drawTranslucent(VkCommandBuffer commandBuffer) {
+    if (translucentIndexCount == 0) return;
+    vkCmdDrawIndexed(commandBuffer, translucentIndexCount, 1, indexCount, 0, 0);
+}
+
+void VoxelMesh::updateTranslucentIndices(const std::vector<uint32_t>& translucentIndices, UploadQueue& uploads) {
+    assert(translucentIndices.size() == translucentIndexCount && "A re-sort must keep the translucent indices");
+    uploads.upload(indexBuffer->getBuffer(), sizeof(uint32_t) * indexCount, translucentIndices.data(), sizeof(uint32_t) * translucentIndexCount);
+}
+
+VkDeviceSize VoxelMesh::getMemoryUsage() const {
+    return vertexBuffer->getBufferSize() + indexBuffer->getBufferSize();
+}
+
+void VoxelMesh::createVertexBuffer(const std::vector<VoxelVertex>& vertices, UploadQueue& uploads) {
+    vertexCount = static_cast<uint32_t>(vertices.size());
+    assert(vertexCount >= 3 && "Vertex count must be at least 3!");
+    uint32_t vertexSize = sizeof(vertices[0]);
+
+    vertexBuffer = std::make_unique<Buffer>(
+        device,
+        vertexSize,
+        vertexCount,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+
+    uploads.upload(vertexBuffer->getBuffer(), 0, vertices.data(), vertexSize * vertexCount);
+}
+
+// One buffer: the opaque indices, then the translucent range
+void VoxelMesh::createIndexBuffer(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& translucentIndices, UploadQueue& uploads) {
+    indexCount = static_cast<uint32_t>(indices.size());
+    translucentIndexCount = static_cast<uint32_t>(translucentIndices.size());
+    const uint32_t totalIndexCount = indexCount + translucentIndexCount;
+    assert(totalIndexCount >= 3 && "Index count must be at least 3!");
+    uint32_t indexSize = sizeof(uint32_t);
+
+    indexBuffer = std::make_unique<Buffer>(
+        device,
+        indexSize,
+        totalIndexCount,
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+
+    uploads.upload(indexBuffer->getBuffer(), 0, indices.data(), indexSize * indexCount);
+    uploads.upload(indexBuffer->getBuffer(), indexSize * indexCount, translucentIndices.data(), indexSize * translucentIndexCount);
+}
+
+std::vector<VkVertexInputBindingDescription> VoxelVertex::getBindingDescriptions() {
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+    bindingDescriptions[0].binding      = 0;
+    bindingDescriptions[0].stride       = sizeof(VoxelVertex);
+    bindingDescriptions[0].inputRate    = VK_VERTEX_INPUT_RATE_VERTEX;
+    return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> VoxelVertex::getAttributeDescriptions() {
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(1);
+    attributeDescriptions[0].location   = 0;
+    attributeDescriptions[0].binding    = 0;
+    attributeDescriptions[0].format     = VK_FORMAT_R32_UINT;
+    attributeDescriptions[0].offset     = offsetof(VoxelVertex, data);
+    return attributeDescriptions;
+}
+
+} // namespace engine
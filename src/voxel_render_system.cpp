@@ -0,0 +1,162 @@
+#include <voxel_render_system.hpp>
+#include <voxel_mesh.hpp>
+
+#define GLM_FORCE_CXX17
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace engine {
+
+struct VoxelPushConstants {
+    glm::vec4 chunkOrigin{}; // w is the block size
+};
+
+VoxelRenderSystem::VoxelRenderSystem(Device& deviceRef, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : device{deviceRef} {
+    createPipelineLayout(globalSetLayout);
+    createPipeline(renderPass);
+}
+
+VoxelRenderSystem::~VoxelRenderSystem() {
+    vkDestroyPipelineLayout(device.getLogicalDevice(), pipelineLayout, nullptr);
+}
+
+void VoxelRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags    = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset        = 0;
+    pushConstantRange.size          = sizeof(VoxelPushConstants);
+
+    std::vector<VkDescriptorSetLayout> descriptorSetLayouts{globalSetLayout};
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType                    = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount           = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts              = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount   = 1;
+    pipelineLayoutInfo.pPushConstantRanges      = &pushConstantRange;
+    if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline layout!");
+    }
+}
+
+void VoxelRenderSystem::createPipeline(VkRenderPass renderPass) {
+    assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
+
+    PipelineConfigInfo pipelineConfig{};
+    Pipeline::defaultPipelineConfigInfo(pipelineConfig);
+    pipelineConfig.bindingDescriptions      = VoxelVertex::getBindingDescriptions();
+    pipelineConfig.attributeDescriptions    = VoxelVertex::getAttributeDescriptions();
+    pipelineConfig.renderPass               = renderPass;
+    pipelineConfig.pipelineLayout           = pipelineLayout;
+    pipeline = std::make_unique<Pipeline>(
+        device,
+        "shaders/voxel.vert.spv",
+        "shaders/voxel.frag.spv",
+        pipelineConfig
+    );
+
+    // Drawn back to front over the finished opaque pass; blended quads must not hide each other
+    Pipeline::enableAlphaBlending(pipelineConfig);
+    pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+    translucentPipeline = std::make_unique<Pipeline>(
+        device,
+        "shaders/voxel.vert.spv",
+        "shaders/voxel.frag.spv",
+        pipelineConfig
+    );
+}
+
+void VoxelRenderSystem::render(FrameInfo& frameInfo) {
+    stats = {};
+    pipeline->bind(frameInfo.commandBuffer);
+
+    vkCmdBindDescriptorSets(
+        frameInfo.commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipelineLayout,
+        0,
+        1,
+        &frameInfo.globalDescriptorSet,
+        0,
+        nullptr
+    );
+
+    for (auto& kv : frameInfo.gameObjects) {
+        auto& obj = kv.second;
+        if (obj.voxelMesh == nullptr) continue;
+
+        VoxelPushConstants push{};
+        push.chunkOrigin = glm::vec4(obj.transform.translation, obj.transform.scale.x);
+
+        vkCmdPushConstants(
+            frameInfo.commandBuffer,
+            pipelineLayout,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0,
+            sizeof(VoxelPushConstants),
+            &push
+        );
+        obj.voxelMesh->bind(frameInfo.commandBuffer);
+        obj.voxelMesh->draw(frameInfo.commandBuffer);
+
+        stats.drawCalls++;
+        stats.triangleCount += obj.voxelMesh->getTriangleCount();
+    }
+}
+
+void VoxelRenderSystem::renderTranslucent(FrameInfo& frameInfo) {
+    // Chunks by the distance to their centers; the quads within each were sorted on a worker
+    std::vector<std::pair<float, GameObject*>> sorted;
+    for (auto& kv : frameInfo.gameObjects) {
+        auto& obj = kv.second;
+        if (obj.voxelMesh == nullptr || !obj.voxelMesh->hasTranslucent()) continue;
+
+        auto offset = frameInfo.camera.getPosition() - (obj.transform.translation + glm::vec3(CHUNK_LENGTH * 0.5f));
+        sorted.emplace_back(glm::dot(offset, offset), &obj);
+    }
+    if (sorted.empty()) return;
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    translucentPipeline->bind(frameInfo.commandBuffer);
+
+    vkCmdBindDescriptorSets(
+        frameInfo.commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipelineLayout,
+        0,
+        1,
+        &frameInfo.globalDescriptorSet,
+        0,
+        nullptr
+    );
+
+    for (auto& entry : sorted) {
+        auto& obj = *entry.second;
+
+        VoxelPushConstants push{};
+        push.chunkOrigin = glm::vec4(obj.transform.translation, obj.transform.scale.x);
+
+        vkCmdPushConstants(
+            frameInfo.commandBuffer,
+            pipelineLayout,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0,
+            sizeof(VoxelPushConstants),
+            &push
+        );
+        obj.voxelMesh->bind(frameInfo.commandBuffer);
+        obj.voxelMesh->drawTranslucent(frameInfo.commandBuffer);
+
+        stats.drawCalls++;
+        stats.triangleCount += obj.voxelMesh->getTranslucentTriangleCount();
+    }
+}
+
+} // namespace engine
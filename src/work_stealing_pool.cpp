@@ -0,0 +1,135 @@
+#include <work_stealing_pool.hpp>
+
+#include <algorithm>
+
+namespace engine {
+
+namespace {
+
+// The pool and deque of the worker running on this thread, so submissions from inside a task
+// stay on that worker's deque
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned workerCount) {
+    workerCount = std::max(1u, workerCount);
+    queues.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; i++) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; i++) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, static_cast<size_t>(i));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock{sleepMutex};
+        stopping.store(true);
+    }
+    wakeUp.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned WorkStealingPool::getDefaultWorkerCount() {
+    const unsigned hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+void WorkStealingPool::submit(Task task) {
+    const size_t index = currentPool == this
+        ? currentWorker
+        : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    pendingTasks.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock{queues[index]->mutex};
+        queues[index]->tasks.push_back(std::move(task));
+    }
+
+    // Taking the lock orders the increment against a thread that just found nothing to do and
+    // is about to sleep, so the wake-up cannot be lost
+    {
+        std::lock_guard<std::mutex> lock{sleepMutex};
+        queuedTasks.fetch_add(1);
+    }
+    wakeUp.notify_one();
+    waiterWakeUp.notify_all();
+}
+
+void WorkStealingPool::wait() {
+    for (;;) {
+        Task task;
+        if (takeTask(nextQueue.load(std::memory_order_relaxed) % queues.size(), task)) {
+            runTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock{sleepMutex};
+        waiterWakeUp.wait(lock, [this]() { return pendingTasks.load() == 0 || queuedTasks.load() > 0; });
+        if (pendingTasks.load() == 0) return;
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    for (size_t i = 0; i < count; i++) {
+        submit([&body, i]() { body(i); });
+    }
+    wait();
+}
+
+// The back of the home deque first, then the fronts of the others starting from the next one,
+// so thieves spread over the victims instead of all draining worker 0
+bool WorkStealingPool::takeTask(size_t home, Task& out) {
+    {
+        WorkerQueue& queue = *queues[home];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+            out = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            queuedTasks.fetch_sub(1);
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        WorkerQueue& queue = *queues[(home + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+            out = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            queuedTasks.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::runTask(Task& task) {
+    task();
+    task = nullptr; // release the captures before the task counts as finished
+    if (pendingTasks.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock{sleepMutex};
+        waiterWakeUp.notify_all();
+    }
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+    for (;;) {
+        Task task;
+        if (takeTask(index, task)) {
+            runTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock{sleepMutex};
+        wakeUp.wait(lock, [this]() { return stopping.load() || queuedTasks.load() > 0; });
+        if (stopping.load()) return;
+    }
+}
+
+} // namespace engine
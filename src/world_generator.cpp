@@ -0,0 +1,225 @@
+#include <world_generator.hpp>
+#include <chunk_random.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <unordered_map>
+
+namespace engine {
+
+namespace {
+
+// Stage noises, frequencies in cycles per block; the climate noises are in climate_map.cpp
+constexpr NoiseSettings HILL_NOISE{NOISE_SIMPLEX, FRACTAL_FBM, 4, 1.f / 96.f};
+constexpr NoiseSettings RIDGE_NOISE{NOISE_SIMPLEX, FRACTAL_RIDGED, 4, 1.f / 192.f};
+constexpr NoiseSettings CAVE_NOISE{NOISE_SIMPLEX, FRACTAL_FBM, 2, 1.f / 40.f};
+
+constexpr float CAVE_THRESHOLD = 0.38f; // cave noise above this is carved out
+constexpr int CAVE_STEP = 4;            // blocks between cave noise samples, see Noise::fillGridCoarse
+constexpr int CAVE_ROOF = 4;            // blocks of ground kept between caves and the surface
+constexpr int DIRT_DEPTH = 3;           // dirt blocks below the top block
+constexpr int SNOW_LINE = WorldGenerator::SEA_LEVEL - 20; // mountain tops above it are bare stone
+constexpr int TREE_ATTEMPTS = 16;       // random columns per chunk tried for a tree
+
+// ChunkRandom streams, one per stage that draws numbers
+constexpr uint32_t STREAM_DIRT_POCKETS = 0;
+constexpr uint32_t STREAM_TREES = 1;
+
+uint32_t getStageSeed(uint64_t seed, uint64_t stage) {
+    return static_cast<uint32_t>(ChunkRandom::mix(seed + stage * 0x9e3779b97f4a7c15ull));
+}
+
+// Floor division, so block -1 lands in chunk -1 rather than chunk 0
+int getChunkCoordinate(int block) {
+    const int length = static_cast<int>(Chunk::LENGTH);
+    return (block >= 0 ? block : block - length + 1) / length;
+}
+
+BlockType getLayerBlock(int worldY, int surface, Biome biome) {
+    if (worldY < surface) return worldY >= WorldGenerator::SEA_LEVEL ? WATER : AIR;
+    const bool bareStone = biome == BIOME_MOUNTAINS && surface < SNOW_LINE;
+    if (worldY == surface) {
+        if (bareStone) return STONE;
+        return biome == BIOME_OCEAN || surface > WorldGenerator::SEA_LEVEL ? DIRT : GRASS;
+    }
+    return worldY <= surface + DIRT_DEPTH && !bareStone ? DIRT : STONE;
+}
+
+} // namespace
+
+WorldGenerator::WorldGenerator(uint64_t seed, NoiseBackend backend)
+    : seed{seed},
+      climate{getStageSeed(seed, 0), backend},
+      hillNoise{getStageSeed(seed, 3), backend},
+      ridgeNoise{getStageSeed(seed, 4), backend},
+      caveNoise{getStageSeed(seed, 5), backend} {}
+
+void WorldGenerator::generate(glm::ivec3 chunkCoord, Chunk& chunk, DecorationQueue& decorations) const {
+    const int length = static_cast<int>(Chunk::LENGTH);
+    const glm::ivec3 origin = chunkCoord * length;
+    const int bottom = origin.y + length - 1;
+
+    ColumnData columns;
+    generateColumns({origin.x, origin.z}, columns);
+    const auto [minSurface, maxSurface] = std::minmax_element(columns.surfaces.begin(), columns.surfaces.end());
+
+    // Sky: nothing to layer, carve or plant. A tree is rooted one block above the surface
+    // (see plantTrees), so the chunk right above the highest column still goes through.
+    if (bottom < *minSurface - 1 && bottom < SEA_LEVEL) {
+        chunk.fill(AIR);
+        return;
+    }
+
+    std::vector<BlockType> blocks(Chunk::SIZE);
+    for (int z = 0; z < length; z++) {
+        for (int x = 0; x < length; x++) {
+            const size_t column = static_cast<size_t>(x + z * length);
+            for (int y = 0; y < length; y++) {
+                blocks[x + (y + z * length) * length] = getLayerBlock(origin.y + y, columns.surfaces[column], columns.biomes[column]);
+            }
+        }
+    }
+
+    // Dirt pockets in the stone, clipped to the chunk
+    ChunkRandom random{seed, chunkCoord, STREAM_DIRT_POCKETS};
+    for (int pocket = random.nextInt(0, 3); pocket > 0; pocket--) {
+        const glm::ivec3 center{random.nextInt(0, length - 1), random.nextInt(0, length - 1), random.nextInt(0, length - 1)};
+        const int radius = random.nextInt(2, 3);
+        for (int z = std::max(center.z - radius, 0); z <= std::min(center.z + radius, length - 1); z++) {
+            for (int y = std::max(center.y - radius, 0); y <= std::min(center.y + radius, length - 1); y++) {
+                for (int x = std::max(center.x - radius, 0); x <= std::min(center.x + radius, length - 1); x++) {
+                    const glm::ivec3 offset = glm::ivec3{x, y, z} - center;
+                    BlockType& block = blocks[x + (y + z * length) * length];
+                    if (offset.x * offset.x + offset.y * offset.y + offset.z * offset.z <= radius * radius && block == STONE) {
+                        block = DIRT;
+                    }
+                }
+            }
+        }
+    }
+
+    if (bottom > *minSurface + CAVE_ROOF) {
+        carveCaves(origin, columns, blocks.data());
+    }
+    plantTrees(chunkCoord, columns, blocks.data(), decorations);
+
+    if (std::all_of(blocks.begin(), blocks.end(), [&blocks](BlockType type) { return type == blocks[0]; })) {
+        chunk.fill(blocks[0]);
+        return;
+    }
+    chunk.fill(AIR);
+    for (int z = 0; z < length; z++) {
+        for (int y = 0; y < length; y++) {
+            chunk.setRow(y, z, blocks.data() + (y + z * length) * length);
+        }
+    }
+}
+
+void WorldGenerator::generate(WorkStealingPool& pool, const std::vector<std::pair<glm::ivec3, Chunk*>>& chunks,
+    DecorationQueue& decorations) const {
+    pool.parallelFor(chunks.size(), [this, &chunks, &decorations](size_t index) {
+        generate(chunks[index].first, *chunks[index].second, decorations);
+    });
+    pool.parallelFor(chunks.size(), [&chunks, &decorations](size_t index) {
+        decorations.apply(chunks[index].first, *chunks[index].second);
+    });
+}
+
+// Biome and heightmap stages. The biome comes from the cached climate layer and is a label for
+// the surface layering; the height uses the blended biome parameters, so it does not jump
+// where the label changes. Only the hill and ridge detail is sampled per column.
+void WorldGenerator::generateColumns(glm::ivec2 origin, ColumnData& columns) const {
+    std::array<ClimateSample, COLUMNS> climates;
+    std::array<float, COLUMNS> hills;
+    std::array<float, COLUMNS> ridges;
+    climate.getColumns(origin, climates.data());
+    hillNoise.fillPlane(HILL_NOISE, origin, hills.data());
+    ridgeNoise.fillPlane(RIDGE_NOISE, origin, ridges.data());
+
+    for (size_t i = 0; i < COLUMNS; i++) {
+        const BiomeParameters& parameters = climates[i].parameters;
+        const float height = climates[i].continentalness * 24.f + hills[i] * parameters.hillAmplitude
+            + ridges[i] * parameters.ridgeAmplitude;
+        columns.surfaces[i] = std::min(std::max(SEA_LEVEL - static_cast<int>(std::floor(height)), MIN_SURFACE), MAX_SURFACE);
+        columns.biomes[i] = climates[i].biome;
+        columns.treeChances[i] = parameters.treeChance;
+    }
+}
+
+// Density stage. The cave field is smooth, so it is sampled on the coarse lattice and
+// interpolated; the surface shape comes from the full-rate column planes of the heightmap
+// stage and does not go through here. Caves keep CAVE_ROOF blocks below the surface, so they
+// never open into the sea.
+void WorldGenerator::carveCaves(glm::ivec3 origin, const ColumnData& columns, BlockType* blocks) const {
+    const int length = static_cast<int>(Chunk::LENGTH);
+    std::vector<float> density(Chunk::SIZE);
+    caveNoise.fillGridCoarse(CAVE_NOISE, origin, CAVE_STEP, density.data());
+    for (int z = 0; z < length; z++) {
+        for (int y = 0; y < length; y++) {
+            for (int x = 0; x < length; x++) {
+                const size_t index = static_cast<size_t>(x + (y + z * length) * length);
+                if (origin.y + y > columns.surfaces[x + z * length] + CAVE_ROOF && density[index] > CAVE_THRESHOLD) {
+                    blocks[index] = AIR;
+                }
+            }
+        }
+    }
+}
+
+// Decoration stage. A tree belongs to the chunk holding its root (the block above the
+// surface), so exactly one chunk plants it; the draws of an attempt come first so every
+// attempt takes as many.
+void WorldGenerator::plantTrees(glm::ivec3 chunkCoord, const ColumnData& columns, BlockType* blocks,
+    DecorationQueue& decorations) const {
+    const int length = static_cast<int>(Chunk::LENGTH);
+    const glm::ivec3 origin = chunkCoord * length;
+    std::unordered_map<glm::ivec3, std::vector<DecorationWrite>> outside;
+    const auto place = [&](glm::ivec3 block, BlockType type) {
+        const glm::ivec3 target{getChunkCoordinate(block.x), getChunkCoordinate(block.y), getChunkCoordinate(block.z)};
+        const glm::ivec3 local = block - target * length;
+        const size_t index = static_cast<size_t>(local.x + (local.y + local.z * length) * length);
+        if (target != chunkCoord) {
+            outside[target].push_back({static_cast<uint16_t>(index), type});
+        } else if (DecorationQueue::overrides(type, blocks[index])) {
+            blocks[index] = type;
+        }
+    };
+
+    ChunkRandom random{seed, chunkCoord, STREAM_TREES};
+    for (int attempt = 0; attempt < TREE_ATTEMPTS; attempt++) {
+        const int x = random.nextInt(0, length - 1);
+        const int z = random.nextInt(0, length - 1);
+        const float roll = random.nextFloat();
+        const int trunkHeight = random.nextInt(4, 6);
+
+        const size_t column = static_cast<size_t>(x + z * length);
+        const int surface = columns.surfaces[column];
+        const Biome biome = columns.biomes[column];
+        const int root = surface - 1; // +y is down: the trunk grows toward lower y
+        if (roll >= columns.treeChances[column] || root < origin.y || root >= origin.y + length) continue;
+        if (getLayerBlock(surface, surface, biome) != GRASS) continue;
+
+        const glm::ivec3 base{origin.x + x, root, origin.z + z};
+        for (int i = 0; i < trunkHeight; i++) {
+            place(base - glm::ivec3{0, i, 0}, LOG);
+        }
+        // Two wide layers around the top of the trunk, two narrow ones over it; no corners
+        const int top = root - trunkHeight + 1;
+        for (int y = top + 1; y >= top - 2; y--) {
+            const int radius = y >= top ? 2 : 1;
+            for (int dz = -radius; dz <= radius; dz++) {
+                for (int dx = -radius; dx <= radius; dx++) {
+                    if (std::abs(dx) == radius && std::abs(dz) == radius) continue;
+                    place({base.x + dx, y, base.z + dz}, LEAVES);
+                }
+            }
+        }
+    }
+
+    for (const auto& [target, writes] : outside) {
+        decorations.push(target, writes);
+    }
+}
+
+} // namespace engine
@@ -0,0 +1,213 @@
+#include <world_storage.hpp>
+#include <chunk_codec.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace engine {
+
+namespace {
+
+void checkStorable(glm::ivec3 chunkCoord) {
+    if (!RegionFile::isStorable(chunkCoord)) {
+        throw std::runtime_error("Chunk outside the vertical extent of region files cannot be saved!");
+    }
+}
+
+} // namespace
+
+WorldStorage::WorldStorage(const std::string& directory, size_t capacity, IoBackend backend)
+    : directory{directory}, capacity{std::max<size_t>(capacity, 1)}, io{backend} {
+    std::filesystem::create_directories(directory);
+}
+
+bool WorldStorage::load(glm::ivec3 chunkCoord, Chunk& chunk) const {
+    if (!RegionFile::isStorable(chunkCoord)) return false;
+    std::shared_ptr<const std::vector<uint8_t>> pendingPayload;
+    {
+        std::lock_guard<std::mutex> lock{writesMutex};
+        auto pending = pendingWrites.find(chunkCoord);
+        if (pending != pendingWrites.end()) pendingPayload = pending->second.payload;
+    }
+    if (pendingPayload) {
+        ChunkCodec::decode(pendingPayload->data(), pendingPayload->size(), chunk);
+        return true;
+    }
+    const std::shared_ptr<RegionFile> region = getRegion(RegionFile::getRegionCoord(chunkCoord), false);
+    if (!region) return false;
+    return region->read(chunkCoord, [&chunk](const uint8_t* data, size_t size) { ChunkCodec::decode(data, size, chunk); });
+}
+
+void WorldStorage::save(glm::ivec3 chunkCoord, const Chunk& chunk) {
+    checkStorable(chunkCoord);
+    std::vector<uint8_t> payload;
+    ChunkCodec::encode(chunk, payload);
+    const std::shared_ptr<RegionFile> region = getRegion(RegionFile::getRegionCoord(chunkCoord), true);
+    // Under the lock, so an asynchronous save of the chunk still in flight cannot land after it
+    std::lock_guard<std::mutex> lock{writesMutex};
+    pendingWrites.erase(chunkCoord);
+    region->write(chunkCoord, payload.data(), payload.size());
+}
+
+void WorldStorage::loadAsync(const std::vector<glm::ivec3>& chunkCoords, const LoadCallback& done) {
+    const auto callback = std::make_shared<LoadCallback>(done);
+    std::vector<AsyncFileIo::Request> batch;
+    for (glm::ivec3 chunkCoord : chunkCoords) {
+        std::vector<uint8_t> payload;
+        {
+            std::lock_guard<std::mutex> lock{writesMutex};
+            auto pending = pendingWrites.find(chunkCoord);
+            if (pending != pendingWrites.end()) payload = *pending->second.payload;
+        }
+        std::shared_ptr<RegionFile> region;
+        RegionFile::Extent extent{};
+        if (payload.empty() && RegionFile::isStorable(chunkCoord)) {
+            region = getRegion(RegionFile::getRegionCoord(chunkCoord), false);
+        }
+        if (!region || !region->beginRead(chunkCoord, extent)) {
+            done(chunkCoord, std::move(payload));
+            continue;
+        }
+
+        const auto buffer = std::make_shared<std::vector<uint8_t>>(extent.size);
+        batch.push_back({region->getNativeFile(), extent.getOffset(), buffer->data(), buffer->size(), false,
+            [region, chunkCoord, buffer, callback](int64_t result) {
+                region->endRead();
+                if (result != static_cast<int64_t>(buffer->size())) {
+                    std::cerr << "Failed to read chunk (" << chunkCoord.x << ", " << chunkCoord.y << ", " << chunkCoord.z
+                              << "): " << (result < 0 ? "error " + std::to_string(-result) : "truncated") << std::endl;
+                    buffer->clear();
+                }
+                (*callback)(chunkCoord, std::move(*buffer));
+            }});
+    }
+    io.submit(std::move(batch));
+}
+
+// The table only points at a payload once its write has completed, and only if no newer save
+// of the chunk was made meanwhile; otherwise its sectors go back to the region. Completed is
+// not durable: like the region's own writes, it is only on disk for sure after flush().
+void WorldStorage::saveAsync(const std::vector<std::pair<glm::ivec3, const Chunk*>>& chunks) {
+    std::vector<AsyncFileIo::Request> batch;
+    for (const auto& [chunkCoord, chunk] : chunks) {
+        checkStorable(chunkCoord);
+        auto payload = std::make_shared<std::vector<uint8_t>>();
+        ChunkCodec::encode(*chunk, *payload);
+        const std::shared_ptr<RegionFile> region = getRegion(RegionFile::getRegionCoord(chunkCoord), true);
+        const RegionFile::Extent extent = region->reserve(payload->size());
+        uint64_t sequence;
+        {
+            std::lock_guard<std::mutex> lock{writesMutex};
+            sequence = ++nextWriteSequence;
+            pendingWrites[chunkCoord] = {sequence, payload};
+        }
+
+        batch.push_back({region->getNativeFile(), extent.getOffset(), payload->data(), payload->size(), true,
+            [this, region, chunkCoord = chunkCoord, extent, sequence, payload](int64_t result) {
+                const bool written = result == static_cast<int64_t>(payload->size());
+                std::lock_guard<std::mutex> lock{writesMutex};
+                auto pending = pendingWrites.find(chunkCoord);
+                const bool latest = pending != pendingWrites.end() && pending->second.sequence == sequence;
+                if (written && latest) {
+                    region->commit(chunkCoord, extent);
+                } else {
+                    region->release(extent);
+                }
+                if (latest) pendingWrites.erase(pending);
+                if (!written) {
+                    std::cerr << "Failed to save chunk (" << chunkCoord.x << ", " << chunkCoord.y << ", " << chunkCoord.z
+                              << "): " << (result < 0 ? "error " + std::to_string(-result) : "truncated") << std::endl;
+                }
+            }});
+    }
+    io.submit(std::move(batch));
+}
+
+void WorldStorage::wait() {
+    io.wait();
+}
+
+// Evicted regions still in use are flushed too; the ones already gone synced on destruction
+void WorldStorage::flush() {
+    io.wait();
+    std::lock_guard<std::mutex> lock{cacheMutex};
+    for (auto& [regionCoord, region] : recentRegions) {
+        region->flush();
+    }
+    for (auto& [regionCoord, evicted] : evictedRegions) {
+        if (const std::shared_ptr<RegionFile> region = evicted.lock()) region->flush();
+    }
+}
+
+void WorldStorage::saveFile(const std::string& name, const std::vector<uint8_t>& data) {
+    const std::filesystem::path path = std::filesystem::path{directory} / name;
+    const std::filesystem::path temporary = std::filesystem::path{directory} / (name + ".tmp");
+    {
+        std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            throw std::runtime_error("Failed to write world file " + temporary.string() + "!");
+        }
+    }
+    std::filesystem::rename(temporary, path);
+}
+
+bool WorldStorage::loadFile(const std::string& name, std::vector<uint8_t>& data) const {
+    const std::filesystem::path path = std::filesystem::path{directory} / name;
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    if (!file) return false;
+    std::vector<uint8_t> contents(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+    if (!file) {
+        throw std::runtime_error("Failed to read world file " + path.string() + "!");
+    }
+    data = std::move(contents);
+    return true;
+}
+
+// Opened under the lock, and an evicted region still in use is taken back rather than opened
+// again: two RegionFiles of the same file would each hand out its free sectors
+std::shared_ptr<RegionFile> WorldStorage::getRegion(glm::ivec2 regionCoord, bool create) const {
+    std::lock_guard<std::mutex> lock{cacheMutex};
+    auto open = openRegions.find(regionCoord);
+    if (open != openRegions.end()) {
+        recentRegions.splice(recentRegions.begin(), recentRegions, open->second);
+        return open->second->second;
+    }
+
+    std::shared_ptr<RegionFile> region;
+    auto evicted = evictedRegions.find(regionCoord);
+    if (evicted != evictedRegions.end()) {
+        region = evicted->second.lock();
+        evictedRegions.erase(evicted);
+    }
+    if (!region) {
+        const std::string path = getRegionPath(regionCoord);
+        if (!create && !std::filesystem::exists(path)) return nullptr;
+        region = std::make_shared<RegionFile>(path);
+    }
+
+    recentRegions.emplace_front(regionCoord, region);
+    openRegions.emplace(regionCoord, recentRegions.begin());
+    if (recentRegions.size() > capacity) {
+        for (auto stale = evictedRegions.begin(); stale != evictedRegions.end();) {
+            stale = stale->second.expired() ? evictedRegions.erase(stale) : std::next(stale);
+        }
+        evictedRegions.emplace(recentRegions.back().first, recentRegions.back().second);
+        openRegions.erase(recentRegions.back().first);
+        recentRegions.pop_back();
+    }
+    return region;
+}
+
+std::string WorldStorage::getRegionPath(glm::ivec2 regionCoord) const {
+    const std::string name = "r." + std::to_string(regionCoord.x) + "." + std::to_string(regionCoord.y) + ".region";
+    return (std::filesystem::path{directory} / name).string();
+}
+
+} // namespace engine